@@ -4,115 +4,131 @@
 std::pair<tedit::Editor::Position, tedit::Editor::Position>
 tedit::Editor::Position::minmax(const Position& a, const Position& b)
 {
+    bool before = a.row < b.row || (a.row == b.row && a.column <= b.column);
+
     return
     {
-        (a.row < b.row ? a : b),
-        (a.row < b.row ? b : a)
+        (before ? a : b),
+        (before ? b : a)
     };
 }
 #pragma endregion // tedit::Editor::Position
 
+#pragma region tedit::Editor::Selection
+bool
+tedit::Editor::Selection::empty()
+const noexcept
+{
+    return anchor.row == head.row && anchor.column == head.column;
+}
+
+std::pair<tedit::Editor::Position, tedit::Editor::Position>
+tedit::Editor::Selection::range()
+const noexcept
+{
+    return Position::minmax(anchor, head);
+}
+
+std::pair<std::size_t, std::size_t>
+tedit::Editor::Selection::columns(const std::size_t row, const std::size_t length)
+const noexcept
+{
+    auto [min, max] = range();
+
+    if (row < min.row || row > max.row) return { 0, 0 };
+
+    std::size_t start = row == min.row ? min.column : 0;
+    std::size_t end = row == max.row ? max.column : length;
+
+    return { start, std::max(start, end) };
+}
+#pragma endregion // tedit::Editor::Selection
+
 #pragma region tedit::Editor::Line
-tedit::Editor::Line::Line(const std::string& content)
-    : m_content(content),
-      m_sf_text(content, Editor::s_default_font.font, Editor::s_default_font.size)
+tedit::Editor::Line::Line(PieceTable& buffer, const std::size_t index)
+    : m_buffer(&buffer),
+      m_index(index)
 {
-    m_selected.setFillColor(sf::Color(120, 120, 120, 200));
 }
 
 void
 tedit::Editor::Line::insertChar(const std::size_t index, const char c)
 {
-    m_content.insert(m_content.begin() + index, c);
-    m_sf_text.setString(m_content);
+    m_buffer->insert(offset() + index, std::string_view(&c, 1));
 }
 
 void
 tedit::Editor::Line::insertString(const std::size_t index, const std::string& str)
 {
-    for (auto s = str.rbegin(); s < str.rend(); s++)
-    {
-        m_content.insert(m_content.begin() + index, *s);
-    }
-    m_sf_text.setString(m_content);
+    m_buffer->insert(offset() + index, str);
 }
 
 void
 tedit::Editor::Line::eraseChar(const std::size_t index)
 {
-    m_content.erase(m_content.begin() + index - 1);
-    m_sf_text.setString(m_content);
+    m_buffer->erase(offset() + index - 1, 1);
 }
 
 void
-tedit::Editor::Line::combine(Line&& line)
+tedit::Editor::Line::combine()
 {
-    m_content += line.m_content;
-    m_sf_text.setString(m_content);
+    if (m_index + 1 < m_buffer->getLinesCount())
+    {
+        m_buffer->erase(offset() + size(), 1);
+    }
 }
 
 void
-tedit::Editor::Line::setIndex(const std::size_t index)
+tedit::Editor::Line::split(const std::size_t index)
 {
-    m_index = index;
-    m_shape.setPosition(0, Editor::s_default_font.size * m_index);
-    m_sf_text.setPosition(0, Editor::s_default_font.size * m_index);
+    insertChar(index, '\n');
 }
 
-void
-tedit::Editor::Line::select(const std::size_t start, const std::size_t length)
+std::size_t
+tedit::Editor::Line::getIndex()
+const noexcept
 {
-    auto char_width = s_default_font.glyph;
-    m_selected.setPosition(char_width * start, Editor::s_default_font.size * m_index);
-    m_selected.setSize(
-        sf::Vector2f(char_width * (length - start),
-            s_default_font.size * 1.1));
+    return m_index;
 }
 
-std::string const&
+std::string
 tedit::Editor::Line::content()
 const
 {
-    return m_content;
-}
-
-void
-tedit::Editor::Line::unselect()
-{
-    m_selected.setSize(sf::Vector2f(0, 0));
+    return m_buffer->line(m_index);
 }
 
 std::string
 tedit::Editor::Line::substr(const std::size_t start, const std::size_t length, const bool erase)
 {
-    std::string s = m_content.substr(start, length);
-    if (erase) m_content.erase(start, length);
-    m_sf_text.setString(m_content);
+    std::size_t begin = offset() + start;
+    std::size_t n = std::min(length, size() - start);
+
+    std::string s = m_buffer->substr(begin, n);
+    if (erase) m_buffer->erase(begin, n);
 
     return s;
 }
 
 bool
 tedit::Editor::Line::empty()
-const noexcept
+const
 {
-    return m_content.empty();
+    return size() == 0;
 }
 
 std::size_t
 tedit::Editor::Line::size()
-const noexcept
+const
 {
-    return m_content.size();
+    return m_buffer->lineLength(m_index);
 }
 
-void
-tedit::Editor::Line::draw(sf::RenderTarget& target, sf::RenderStates states)
+std::size_t
+tedit::Editor::Line::offset()
 const
 {
-    target.draw(m_shape, states);
-    target.draw(m_selected, states);
-    target.draw(m_sf_text, states);
+    return m_buffer->lineOffset(m_index);
 }
 #pragma endregion // tedit::Editor::Line
 
@@ -136,14 +152,13 @@ const noexcept
 void
 tedit::Editor::Cursor::setPosition(const std::size_t column, const std::size_t row)
 {
-    float x = column * m_char_width;
-    float y = row * m_char_height;
     m_shape.setPosition(column * m_char_width, row * m_char_height);
 
+    // Not worked back out of the shape, a float loses rows past a few million
     m_position =
     {
-        .row    = static_cast<std::size_t>(y / m_char_height),
-        .column = static_cast<std::size_t>(x / m_char_width),
+        .row    = row,
+        .column = column,
     };
 }
 
@@ -162,6 +177,13 @@ tedit::Editor::Cursor::setSize(const sf::Vector2f& size)
     m_char_height = getSize().y;
 }
 
+const sf::RectangleShape&
+tedit::Editor::Cursor::getShape()
+const noexcept
+{
+    return m_shape;
+}
+
 void
 tedit::Editor::Cursor::draw(sf::RenderTarget & target, sf::RenderStates states)
 const
@@ -184,17 +206,25 @@ tedit::Editor::Font     tedit::Editor::s_default_font             =
     };
 tedit::Editor::Color    tedit::Editor::s_default_background_color = { .red = 31, .green = 31, .blue = 31, .alpha = 255 };
 
-tedit::Editor::Editor(const std::size_t width, const std::size_t height)
+tedit::Editor::Editor(WorkerPool& workers, const std::size_t width, const std::size_t height)
     : m_size(sf::Vector2f(width, height)),
       m_shape(m_size),
       m_cursor(sf::Vector2f(2, s_default_font.size)),
       m_current_mode(Mode::Insert),
+      m_workers(workers),
+      m_highlight(true),
       m_saved(false),
+      m_saving_version(0),
+      m_save_requested(false),
       m_vscroller(Scroller::Vertical, height),
       m_vscrolled(0),
       m_hscroller(Scroller::Horizontal, width),
       m_hscrolled(0),
-      m_hmax(0)
+      m_hmax(0),
+      m_replace_version(0),
+      m_truncated(false),
+      m_dirty(true),
+      m_layout{ .pending = true, .follow_cursor = true }
 {
     m_shape.setFillColor(
         sf::Color(s_default_background_color.red,
@@ -203,85 +233,259 @@ tedit::Editor::Editor(const std::size_t width, const std::size_t height)
             s_default_background_color.alpha));
     m_vscroller.setPosition(width - TEDIT_SCROLL_SIZE, 0);
     m_hscroller.setPosition(0 , height - TEDIT_SCROLL_SIZE);
-
-    m_lines.push_back(std::shared_ptr<Line>(new Line("")));
-}
-
-tedit::Editor::Editor(const std::vector<std::shared_ptr<Line>>& lines, const std::size_t width, const std::size_t height)
-    : Editor(width, height)
-{
-    m_lines = lines;
+    m_buffer.attach(&m_history);
+    m_buffer.attach(&m_highlighter);
 }
 
-tedit::Editor::Editor(std::vector<std::shared_ptr<Line>>&& lines, const std::size_t width, const std::size_t height)
-    : Editor(width, height)
+tedit::Editor::Editor(WorkerPool& workers, std::string content, const std::size_t width, const std::size_t height)
+    : Editor(workers, width, height)
 {
-    m_lines = std::move(lines);
+    m_buffer = PieceTable(std::move(content));
+    m_buffer.attach(&m_history);
+    m_buffer.attach(&m_highlighter);
+    invalidateLayout();
 }
 
 tedit::Editor::Editor::~Editor()
 {
-    if (m_file)
+    // Nothing is left to take the answer of a dialog, it is closed so
+    // the pool can join the worker it runs on
+    if (m_asking)
+    {
+        m_asking->cancel();
+    }
+
+    if (m_highlighting)
+    {
+        m_highlighting->cancel();
+    }
+
+    m_replacer.reset();
+    m_pending_replace.reset();
+    waitForSave();
+
+    // Keep the journal around when there is something to recover
+    if (m_journal && m_saved)
     {
-        m_file->close();
+        m_journal->discard();
     }
 }
 
 void
-tedit::Editor::draw(sf::RenderTarget& target, sf::RenderStates states)
+tedit::Editor::snapshot(EditorView::State& state)
 const
 {
-    target.draw(m_shape, states);
+    // Only the rows in the viewport are copied, so a frame costs the
+    // same whatever the length of the file. They are rounded out to
+    // whole tiles, which the view rasterizes and caches together
+    auto [first_row, last_row] = drawnRows();
+
+    // Only the columns that can be seen, long lines would otherwise be
+    // copied and laid out in full every frame
+    std::size_t first_column = m_hscrolled / s_default_font.glyph;
+    std::size_t columns = m_size.x / s_default_font.glyph + 2;
+
+    // Everything is placed relative to the first visible row and column,
+    // floats cannot tell pixels apart a few million rows in
+    double origin_x = first_column * static_cast<double>(s_default_font.glyph);
+    std::size_t origin_y = first_row * s_default_font.size;
+
+    auto const to_x = [&](const std::size_t column)
+    {
+        return static_cast<float>(column * static_cast<double>(s_default_font.glyph) - origin_x);
+    };
+    auto const to_y = [&](const std::size_t row)
+    {
+        return static_cast<float>((static_cast<double>(row) - first_row) * s_default_font.size);
+    };
+
+    state.background = m_shape;
+    state.vscroller = m_vscroller.getShape();
+    state.hscroller = m_hscroller.getShape();
+    state.vscrolled = m_vscrolled - origin_y;
+    state.hscrolled = m_hscrolled - origin_x;
+
+    auto cursor = m_cursor.getPosition();
+    state.cursor = m_cursor.getShape();
+    state.cursor.setPosition(to_x(cursor.column), to_y(cursor.row));
+
+    state.selection.clear();
+
+    if (m_current_mode == Mode::Visual && !m_selection.empty())
+    {
+        auto [min, max] = m_selection.range();
+
+        for (std::size_t row = std::max(min.row, first_row); row <= max.row && row < last_row; ++row)
+        {
+            auto [start, end] = m_selection.columns(row, m_buffer.lineLength(row));
+
+            state.selection.push_back(
+                sf::FloatRect(to_x(start), to_y(row),
+                    s_default_font.glyph * (end - start), s_default_font.size * 1.1));
+        }
+    }
+
+    state.status.clear();
+
+    if (m_search)
+    {
+        bool found = m_search->matches.empty() || m_search->matches.back();
+
+        if (!m_search->matches.empty() && found)
+        {
+            Position match = toPosition(*m_search->matches.back());
+
+            if (match.row >= first_row && match.row < last_row)
+            {
+                state.selection.push_back(
+                    sf::FloatRect(to_x(match.column), to_y(match.row),
+                        s_default_font.glyph * m_search->query.size(), s_default_font.size * 1.1));
+            }
+        }
 
-    std::size_t index = 0;
-    sf::Transform old = states.transform;
-    states.transform *= sf::Transform(
-                                    1, 0, -1.0f * m_hscrolled,
-                                    0, 1, -1.0f * m_vscrolled,
-                                    0, 0, 1);
-    for (auto& line : m_lines)
+        state.status = (found ? "Search: " : "Failing search: ") + m_search->query;
+    }
+    else if (m_replacer)
+    {
+        state.status = "Replacing: " + std::to_string(m_replacer->found()) + " matches";
+    }
+    else if (m_pending_replace)
     {
-        line->setIndex(index++);
-        target.draw(*line, states);
+        state.status = "Replacing once the file is loaded";
     }
+    else
+    {
+        state.status = m_notice;
+    }
+
+    state.first_row = first_row;
+    state.first_column = first_column;
+    state.non_ascii = m_buffer.hasNonAscii();
+    state.rows.resize(last_row - first_row);
+    state.kinds.resize(last_row - first_row);
+
+    std::vector<Highlighter::Kind> kinds;
+
+    for (std::size_t row = first_row; row < last_row; ++row)
+    {
+        std::string& content = state.rows[row - first_row];
+        auto& colored = state.kinds[row - first_row];
+        content.clear();
+        colored.clear();
+
+        std::size_t length = m_buffer.lineLength(row);
+        if (first_column >= length) continue;
 
-    target.draw(m_cursor, states);
-    states.transform = old;
+        // Lexing has to start from the beginning of the line, from the
+        // state the line before ended in
+        if (m_highlight && length <= TEDIT_HIGHLIGHT_MAX_LINE)
+        {
+            content = m_buffer.substr(m_buffer.lineOffset(row), std::min(length, first_column + columns));
+            kinds.resize(content.size());
+            Highlighter::lex(content, m_highlighter.stateAt(row), kinds.data());
+
+            colored.assign(kinds.begin() + first_column, kinds.end());
+            content.erase(0, first_column);
+            continue;
+        }
+
+        content = m_buffer.substr(m_buffer.lineOffset(row) + first_column, columns);
+    }
 
-    target.draw(m_vscroller, states);
-    target.draw(m_hscroller, states);
+    state.progress = m_indexer ? m_indexer->progress() : -1.0f;
 }
 
-std::shared_ptr<tedit::Editor::Line>&
+tedit::Editor::Line
 tedit::Editor::at(const std::size_t index)
 {
-    return m_lines.at(index);
+    if (index >= getLinesCount())
+    {
+        throw std::out_of_range("tedit::Editor::at");
+    }
+
+    return Line(m_buffer, index);
 }
 
-std::shared_ptr<tedit::Editor::Line>&
+tedit::Editor::Line
 tedit::Editor::operator[](const std::size_t index)
 {
-    return m_lines[index];
+    return Line(m_buffer, index);
 }
 
 void
-tedit::Editor::insertLine(const std::size_t index, tedit::Editor::Line* line)
+tedit::Editor::insertLine(const std::size_t index, const std::string& content)
 {
-    m_lines.insert(m_lines.begin() + index, std::shared_ptr<Line>(line));
+    if (index < getLinesCount())
+    {
+        m_buffer.insert(m_buffer.lineOffset(index), content + '\n');
+    }
+    else
+    {
+        m_buffer.insert(m_buffer.length(), '\n' + content);
+    }
+
+    invalidateLayout(false);
 }
 
 void
 tedit::Editor::eraseLine(const std::size_t index)
 {
-    m_lines.erase(m_lines.begin() + index);
+    std::size_t begin = m_buffer.lineOffset(index);
+
+    if (index + 1 < getLinesCount())
+    {
+        m_buffer.erase(begin, m_buffer.lineOffset(index + 1) - begin);
+    }
+    else if (index > 0)
+    {
+        m_buffer.erase(begin - 1, m_buffer.length() - begin + 1);
+    }
+    else
+    {
+        m_buffer.erase(0, m_buffer.length());
+    }
+
+    invalidateLayout(false);
 }
 
 void
 tedit::Editor::write(const char c)
+{
+    write(std::string_view(&c, 1));
+}
+
+void
+tedit::Editor::write(const std::string_view text)
 {
     Position cursor_position = m_cursor.getPosition();
-    std::shared_ptr<Line> line = m_lines[cursor_position.row];
 
+    for (std::size_t i = 0; i < text.size();)
+    {
+        Line line = (*this)[cursor_position.row];
+
+        // Runs of plain characters go in with a single insert
+        std::size_t run = text.find_first_of("\x0d\n\b\x7f\t", i);
+        run = run == std::string_view::npos ? text.size() : run;
+
+        if (run > i)
+        {
+            line.insertString(cursor_position.column, std::string(text.substr(i, run - i)));
+            cursor_position.column += run - i;
+            i = run;
+            continue;
+        }
+
+        writeControl(text[i++], line, cursor_position);
+    }
+
+    m_saved = false;
+    m_cursor.setPosition(cursor_position.column, cursor_position.row);
+    invalidateLayout();
+}
+
+void
+tedit::Editor::writeControl(const char c, Line& line, Position& cursor_position)
+{
     switch (c)
     {
     case '\x0d':
@@ -306,22 +510,21 @@ tedit::Editor::write(const char c)
         }
         break;
     default:
-        line->insertChar(cursor_position.column++, c);
+        line.insertChar(cursor_position.column++, c);
     }
+}
 
-    m_hmax = 0;
-    for (auto const &line : m_lines)
-    {
-        if (line->size() > m_hmax)
-        {
-            m_hmax = line->size();
-        }
-    }
+tedit::Editor::Position
+tedit::Editor::insertText(const Position& position, const std::string_view text)
+{
+    std::size_t offset = toOffset(position);
+    m_buffer.insert(offset, text);
 
+    Position end = toPosition(offset + text.size());
     m_saved = false;
-    m_cursor.setPosition(cursor_position.column, cursor_position.row);
-    resizeScroller();
-    scrollToCursor();
+    invalidateLayout(false);
+
+    return end;
 }
 
 tedit::Editor::Mode::Type
@@ -334,21 +537,11 @@ const noexcept
 void
 tedit::Editor::setCurrentMode(const tedit::Editor::Mode::Type type)
 {
-    if (m_current_mode == Mode::Visual)
-    {
-        std::size_t max = std::max(m_selected_start.row, m_selected_end.row);
-        for (std::size_t i = std::min(m_selected_start.row, m_selected_end.row); i <= max; i++)
-        {
-            m_lines[i]->unselect();
-        }
-    }
-
     m_current_mode = type;
 
     if (type == Mode::Visual)
     {
-        m_selected_start = m_cursor.getPosition();
-        m_selected_end = m_cursor.getPosition();
+        m_selection = { .anchor = m_cursor.getPosition(), .head = m_cursor.getPosition() };
     }
 }
 
@@ -366,14 +559,15 @@ tedit::Editor::setSize(const std::size_t width, const std::size_t height)
     m_shape.setSize(sf::Vector2f(width, height));
     m_vscroller.setX(width - TEDIT_SCROLL_SIZE);
     m_hscroller.setY(height - TEDIT_SCROLL_SIZE);
-    resizeScroller();
+    invalidateLayout();
+    m_dirty = true;
 }
 
 std::size_t
 tedit::Editor::getLinesCount()
 const noexcept
 {
-    return m_lines.size();
+    return m_buffer.getLinesCount();
 }
 
 void
@@ -390,30 +584,30 @@ tedit::Editor::move(const Direction direction)
         break;
     case Direction::End:
         {
-            cursor_position.column = m_lines[cursor_position.row]->size();
+            cursor_position.column = m_buffer.lineLength(cursor_position.row);
         }
         break;
     case Direction::Up:
         {
             if (cursor_position.row > 0)
             {
-                std::size_t prev_size = m_lines[--cursor_position.row]->size();
+                std::size_t prev_size = m_buffer.lineLength(--cursor_position.row);
                 cursor_position.column = std::min(cursor_position.column, prev_size);
             }
         }
         break;
     case Direction::Down:
         {
-            if (cursor_position.row < m_lines.size() - 1)
+            if (cursor_position.row < getLinesCount() - 1)
             {
-                std::size_t next_size = m_lines[++cursor_position.row]->size();
+                std::size_t next_size = m_buffer.lineLength(++cursor_position.row);
                 cursor_position.column = std::min(cursor_position.column, next_size);
             }
         }
         break;
     case Direction::Right:
         {
-            if (cursor_position.column < m_lines[cursor_position.row]->size())
+            if (cursor_position.column < m_buffer.lineLength(cursor_position.row))
             {
                 cursor_position.column++;
             }
@@ -431,7 +625,7 @@ tedit::Editor::move(const Direction direction)
     }
 
     m_cursor.setPosition(cursor_position.column, cursor_position.row);
-    scrollToCursor();
+    invalidateLayout();
 
     if (m_current_mode == Mode::Visual)
     {
@@ -439,39 +633,175 @@ tedit::Editor::move(const Direction direction)
     }
 }
 
-void
-tedit::Editor::handleSelect()
+std::size_t
+tedit::Editor::toOffset(const Position& position)
+const
+{
+    std::size_t row = std::min(position.row, getLinesCount() - 1);
+    return m_buffer.lineOffset(row) + std::min(position.column, m_buffer.lineLength(row));
+}
+
+tedit::Editor::Position
+tedit::Editor::toPosition(const std::size_t offset)
+const
+{
+    std::size_t row = m_buffer.rowAt(offset);
+    return { .row = row, .column = offset - m_buffer.lineOffset(row) };
+}
+
+std::pair<std::size_t, std::size_t>
+tedit::Editor::visibleRows()
+const noexcept
+{
+    std::size_t first = m_vscrolled / s_default_font.size;
+    std::size_t last = (m_vscrolled + static_cast<std::size_t>(m_size.y)) / s_default_font.size + 1;
+
+    first = first > TEDIT_OVERSCAN ? first - TEDIT_OVERSCAN : 0;
+    last = std::min(last + TEDIT_OVERSCAN, getLinesCount());
+
+    return { std::min(first, last), last };
+}
+
+std::pair<std::size_t, std::size_t>
+tedit::Editor::drawnRows()
+const noexcept
 {
-    m_selected_end = m_cursor.getPosition();
+    auto [first, last] = visibleRows();
+    first -= first % TEDIT_TILE_ROWS;
+    last = std::min((last + TEDIT_TILE_ROWS - 1) / TEDIT_TILE_ROWS * TEDIT_TILE_ROWS, getLinesCount());
 
-    auto [min, max] = Position::minmax(m_selected_start, m_selected_end);
+    return { first, last };
+}
 
-    for (std::size_t i = min.row + 1; i < max.row; ++i)
+tedit::Editor::Frame
+tedit::Editor::capture()
+const noexcept
+{
+    return
     {
-        m_lines[i]->select(0, m_lines[i]->size());
-    }
+        .cursor         = m_cursor.getPosition(),
+        .selection      = m_selection,
+        .mode           = m_current_mode,
+        .vscrolled      = m_vscrolled,
+        .hscrolled      = m_hscrolled,
+        .version        = m_buffer.version(),
+        .lines          = getLinesCount(),
+        .hmax           = m_hmax,
+        .query          = m_search ? m_search->query.size() : 0,
+    };
+}
 
-    if (min.row > 0 && min.row - 1 > 0)
-        m_lines[min.row - 1]->unselect();
-    if (max.row + 1 < m_lines.size())
-        m_lines[max.row + 1]->unselect();
+void
+tedit::Editor::damage(const Frame& before)
+noexcept
+{
+    Frame after = capture();
 
-    if (min.row != max.row)
+    auto same = [](const Position& a, const Position& b)
     {
-        m_lines[min.row]->select(min.column, m_lines[min.row]->size());
-        m_lines[max.row]->select(0, max.column);
-    }
-    else
+        return a.row == b.row && a.column == b.column;
+    };
+
+    m_dirty |= before.vscrolled != after.vscrolled
+        || before.hscrolled != after.hscrolled
+        || before.version != after.version
+        || before.lines != after.lines
+        || before.hmax != after.hmax
+        || before.mode != after.mode
+        || before.query != after.query
+        || !same(before.cursor, after.cursor)
+        || !same(before.selection.anchor, after.selection.anchor)
+        || !same(before.selection.head, after.selection.head);
+}
+
+void
+tedit::Editor::layout()
+{
+    if (m_layout.pending)
     {
-        std::size_t min_column = std::min(m_selected_start.column, m_selected_end.column);
-        std::size_t max_column = std::max(m_selected_start.column, m_selected_end.column);
-        m_lines[max.row]->select(min_column, max_column);
+        Frame before = capture();
+
+        // Kept up to date by the buffer on every edit
+        m_hmax = m_buffer.maxLineLength();
+
+        resizeScroller(m_layout.follow_cursor);
+        m_layout = { .pending = false, .follow_cursor = false };
+
+        damage(before);
     }
+
+    // Once the view has settled, so the lines lexed first are the ones
+    // about to be drawn
+    highlight();
+}
+
+void
+tedit::Editor::invalidateLayout(const bool follow_cursor)
+noexcept
+{
+    m_layout.pending = true;
+    m_layout.follow_cursor |= follow_cursor;
+}
+
+void
+tedit::Editor::highlight()
+{
+    if (!m_highlight) return;
+
+    auto [first_row, last_row] = drawnRows();
+    auto [first, last] = m_highlighter.relex(m_buffer, last_row);
+    m_dirty |= std::max(first, first_row) < std::min(last, last_row);
+
+    if (m_highlighting) return;
+
+    auto job = std::make_shared<Highlighter::Job>();
+    if (!m_highlighter.prepare(m_buffer, *job)) return;
+
+    m_highlighting = m_workers.submit(WorkerPool::Priority::Low,
+        [job, snapshot = m_buffer.snapshot()](const WorkerPool::Token&)
+        {
+            Highlighter::run(snapshot, *job);
+            return job;
+        },
+        [this](std::shared_ptr<Highlighter::Job> job)
+        {
+            m_highlighting.reset();
+
+            // Dropped when the text changed meanwhile, the next job
+            // starts over from the first line still dirty
+            auto [first, last] = m_highlighter.merge(*job);
+            auto [first_row, last_row] = drawnRows();
+            m_dirty |= std::max(first, first_row) < std::min(last, last_row);
+        });
+}
+
+bool
+tedit::Editor::isSource(const std::string& filename)
+noexcept
+{
+    static constexpr std::string_view extensions[] =
+    {
+        ".c", ".cc", ".cpp", ".cxx", ".h", ".hh", ".hpp", ".hxx", ".inl",
+    };
+
+    std::size_t dot = filename.rfind('.');
+    if (dot == std::string::npos) return false;
+
+    std::string_view extension = std::string_view(filename).substr(dot);
+    return std::find(std::begin(extensions), std::end(extensions), extension) != std::end(extensions);
+}
+
+void
+tedit::Editor::handleSelect()
+{
+    m_selection.head = m_cursor.getPosition();
 }
 
 void
 tedit::Editor::handleEvent(const sf::Event event)
 {
+    Frame before = capture();
+
     switch (event.type)
     {
     case sf::Event::EventType::TextEntered:
@@ -480,6 +810,10 @@ tedit::Editor::handleEvent(const sf::Event event)
             {
                 write(static_cast<char>(event.text.unicode));
             }
+            else if (getCurrentMode() == tedit::Editor::Mode::Search)
+            {
+                handleSearch(static_cast<char>(event.text.unicode));
+            }
         }
         break;
     case sf::Event::Event::KeyPressed:
@@ -489,7 +823,9 @@ tedit::Editor::handleEvent(const sf::Event event)
         break;
     case sf::Event::EventType::KeyReleased:
         {
-            if (!event.key.control && getCurrentMode() != tedit::Editor::Mode::Visual)
+            if (!event.key.control
+                && getCurrentMode() != tedit::Editor::Mode::Visual
+                && getCurrentMode() != tedit::Editor::Mode::Search)
             {
                 setCurrentMode(tedit::Editor::Mode::Insert);
             }
@@ -512,38 +848,151 @@ tedit::Editor::handleEvent(const sf::Event event)
             handleMouseScrolling(event.mouseMove.x, event.mouseMove.y);
         }
         break;
+    case sf::Event::EventType::MouseWheelScrolled:
+        {
+            handleMouseWheel(event.mouseWheelScroll);
+        }
+        break;
+    case sf::Event::EventType::GainedFocus:
+        {
+            // The window may have been covered, its content is gone
+            m_dirty = true;
+        }
+        break;
     default: {}
     }
+
+    damage(before);
 }
-bool
-tedit::Editor::isSaved()
-const noexcept
+
+void
+tedit::Editor::handleText(const std::string_view text)
 {
-    return m_saved;
+    Frame before = capture();
+
+    if (getCurrentMode() == tedit::Editor::Mode::Insert)
+    {
+        write(text);
+    }
+
+    damage(before);
 }
 
 void
-tedit::Editor::handleKeyPress(const sf::Event::KeyEvent key)
+tedit::Editor::update()
 {
-    if (!key.control && getCurrentMode() != tedit::Editor::Mode::Visual)
+    Frame before = capture();
+    bool loading = m_indexer != nullptr;
+
+    loadChunks(false);
+
+    if (m_pending_replace && !m_indexer)
     {
-        setCurrentMode(tedit::Editor::Mode::Insert);
+        auto [regex, format] = std::move(*m_pending_replace);
+        m_pending_replace.reset();
+        startReplace(std::move(regex), std::move(format));
     }
-    else
+
+    // Jobs that finished in the background carry on from here, on this
+    // thread, so their changes are part of this frame's damage
+    m_workers.dispatch();
+
+    bool replacing = m_replacer != nullptr;
+
+    if (m_replacer && m_replacer->isDone())
     {
-        if (getCurrentMode() != tedit::Editor::Mode::Visual)
-        {
-            setCurrentMode(tedit::Editor::Mode::Normal);
-        }
+        finishReplace();
+    }
 
-        Position cursor_position = m_cursor.getPosition();
-        std::shared_ptr<Line> line = m_lines[cursor_position.row];
+    // Noticed on the first read past the new end, by whichever thread
+    if (!m_truncated && m_buffer.isDamaged())
+    {
+        m_truncated = true;
+        m_notice = "The file was truncated on disk, the text past its new end reads as zeros";
+        m_dirty = true;
+    }
 
-        switch (key.code)
-        {
-        case sf::Keyboard::A:
-            {
-                move(tedit::Editor::Direction::Begin);
+    damage(before);
+
+    // The progress bar moves while the file loads, and the count of
+    // matches while they are searched for
+    m_dirty |= loading || replacing;
+}
+
+bool
+tedit::Editor::isSaved()
+const noexcept
+{
+    return m_saved;
+}
+
+bool
+tedit::Editor::isBusy()
+const noexcept
+{
+    return m_indexer || m_saving || m_asking || m_replacer || m_pending_replace || m_highlighting;
+}
+
+bool
+tedit::Editor::isDirty()
+const noexcept
+{
+    return m_dirty;
+}
+
+void
+tedit::Editor::clearDamage()
+noexcept
+{
+    m_dirty = false;
+}
+
+void
+tedit::Editor::handleKeyPress(const sf::Event::KeyEvent key)
+{
+    if (!m_notice.empty())
+    {
+        m_notice.clear();
+        m_dirty = true;
+    }
+
+    if (getCurrentMode() == tedit::Editor::Mode::Search)
+    {
+        // The query, enter and escape come through TextEntered
+        if (!key.control) return;
+
+        if (key.code == sf::Keyboard::R)
+        {
+            nextMatch();
+            return;
+        }
+
+        // Any other command ends the search where it is, then runs
+        endSearch(true);
+    }
+
+    if (!key.control && getCurrentMode() != tedit::Editor::Mode::Visual)
+    {
+        setCurrentMode(tedit::Editor::Mode::Insert);
+    }
+    else
+    {
+        if (getCurrentMode() != tedit::Editor::Mode::Visual)
+        {
+            setCurrentMode(tedit::Editor::Mode::Normal);
+        }
+
+        Position cursor_position = m_cursor.getPosition();
+        Line line = (*this)[cursor_position.row];
+
+        // Commands are undone on their own, not with the typing around them
+        m_history.seal();
+
+        switch (key.code)
+        {
+        case sf::Keyboard::A:
+            {
+                move(tedit::Editor::Direction::Begin);
             }
             break;
         case sf::Keyboard::E:
@@ -628,114 +1077,391 @@ tedit::Editor::handleKeyPress(const sf::Event::KeyEvent key)
                 open();
             }
             break;
+        case sf::Keyboard::Z:
+            {
+                key.shift ? redo() : undo();
+            }
+            break;
+        case sf::Keyboard::R:
+            {
+                startSearch();
+            }
+            break;
+        case sf::Keyboard::Q:
+            {
+                replaceAll();
+            }
+            break;
         default: {}
         }
 
-        resizeScroller();
-        scrollToCursor();
+        m_history.seal();
+        invalidateLayout();
     }
 }
 
 void
-tedit::Editor::deleteForward(std::shared_ptr<Line>& current_line, Position& cursor_position)
+tedit::Editor::deleteForward(Line& current_line, Position& cursor_position)
 {
-    if (cursor_position.column < current_line->size())
+    if (cursor_position.column < current_line.size())
     {
-        current_line->eraseChar(cursor_position.column + 1);
+        current_line.eraseChar(cursor_position.column + 1);
     }
-    else if (cursor_position.row < m_lines.size() - 1)
+    else if (cursor_position.row < getLinesCount() - 1)
     {
-        current_line->combine(std::move(*m_lines[cursor_position.row + 1]));
-        m_lines.erase(m_lines.begin() + cursor_position.row + 1);
+        current_line.combine();
     }
 }
 
 void
-tedit::Editor::deleteBackward(std::shared_ptr<Line>& current_line, Position& cursor_position)
+tedit::Editor::deleteBackward(Line& current_line, Position& cursor_position)
 {
     if (cursor_position.row != 0 && !cursor_position.column)
     {
-        if (current_line->empty())
-        {
-            m_lines.erase(m_lines.begin() + cursor_position.row--);
-            cursor_position.column = m_lines[cursor_position.row]->size();
-        }
-        else
-        {
-            std::shared_ptr<Line> prev = m_lines[cursor_position.row - 1];
-            cursor_position.column = prev->size();
-            prev->combine(std::move(*current_line));
-            m_lines.erase(m_lines.begin() + cursor_position.row--);
-        }
+        Line prev = (*this)[--cursor_position.row];
+        cursor_position.column = prev.size();
+        prev.combine();
     }
-    else if (!current_line->empty() && cursor_position.column)
+    else if (!current_line.empty() && cursor_position.column)
     {
-        current_line->eraseChar(cursor_position.column--);
+        current_line.eraseChar(cursor_position.column--);
     }
 }
 
 void
-tedit::Editor::insertNewLine(std::shared_ptr<Line>& current_line, Position& cursor_position)
+tedit::Editor::insertNewLine(Line& current_line, Position& cursor_position)
 {
-    std::shared_ptr<Line> newline(new Line(current_line->substr(cursor_position.column, current_line->size(), true)));
-    m_lines.insert(m_lines.begin() + ++cursor_position.row, std::move(newline));
+    current_line.split(cursor_position.column);
+    ++cursor_position.row;
     cursor_position.column = 0;
 }
 
 void
-tedit::Editor::insertTab(std::shared_ptr<Line>& current_line, Position& cursor_position)
+tedit::Editor::insertTab(Line& current_line, Position& cursor_position)
 {
-    current_line->insertString(cursor_position.column, "    ");
+    current_line.insertString(cursor_position.column, "    ");
     cursor_position.column += 4;
 }
 
 void
 tedit::Editor::copy(bool erase)
 {
-    auto [min, max] = Position::minmax(m_selected_start, m_selected_end);
+    auto [min, max] = m_selection.range();
+
+    std::size_t begin = toOffset(min);
+    std::size_t end = toOffset(max);
 
-    m_clipboard = "";
+    m_clipboard = m_buffer.substr(begin, end - begin);
 
-    if (min.row != max.row)
+    if (erase)
     {
-        for (std::size_t i = min.row; i <= max.row; ++i)
+        m_buffer.erase(begin, end - begin);
+        m_saved = false;
+    }
+
+    min = toPosition(begin);
+    m_selection = { .anchor = min, .head = min };
+    m_cursor.setPosition(min.column, min.row);
+    invalidateLayout();
+}
+
+void
+tedit::Editor::paste()
+{
+    Position end = insertText(m_cursor.getPosition(), m_clipboard);
+    m_cursor.setPosition(end.column, end.row);
+}
+
+void
+tedit::Editor::undo()
+{
+    auto offset = m_history.undo(m_buffer);
+    if (!offset) return;
+
+    Position position = toPosition(*offset);
+    m_cursor.setPosition(position.column, position.row);
+    m_saved = false;
+}
+
+void
+tedit::Editor::redo()
+{
+    auto offset = m_history.redo(m_buffer);
+    if (!offset) return;
+
+    Position position = toPosition(*offset);
+    m_cursor.setPosition(position.column, position.row);
+    m_saved = false;
+}
+
+void
+tedit::Editor::startSearch()
+{
+    m_search = Search
+    {
+        .query   = {},
+        .origin  = toOffset(m_cursor.getPosition()),
+        .matches = {},
+    };
+
+    setCurrentMode(Mode::Search);
+}
+
+void
+tedit::Editor::handleSearch(const char c)
+{
+    auto& search = *m_search;
+
+    if (c == '\b')
+    {
+        if (search.query.empty()) return;
+
+        // The match of the shorter query was kept, nothing to search
+        search.query.pop_back();
+        search.matches.pop_back();
+    }
+    else if (c == '\r' || c == '\n' || c == '\x1b')
+    {
+        endSearch(c != '\x1b');
+        return;
+    }
+    else if (static_cast<unsigned char>(c) >= 0x20 && c != '\x7f')
+    {
+        // A match of the longer query is a match of the shorter one too,
+        // so there is none before the last one found
+        auto previous = search.matches.empty()
+            ? std::optional<std::size_t>(search.origin)
+            : search.matches.back();
+
+        search.query += c;
+        search.matches.push_back(previous ? findFrom(*previous) : std::nullopt);
+    }
+
+    showMatch();
+}
+
+void
+tedit::Editor::nextMatch()
+{
+    auto& search = *m_search;
+    if (search.matches.empty() || !search.matches.back()) return;
+
+    search.matches.back() = findFrom(*search.matches.back() + 1);
+    showMatch();
+}
+
+void
+tedit::Editor::endSearch(const bool accept)
+{
+    if (!accept)
+    {
+        Position origin = toPosition(m_search->origin);
+        m_cursor.setPosition(origin.column, origin.row);
+    }
+
+    m_search.reset();
+    setCurrentMode(Mode::Insert);
+    invalidateLayout();
+}
+
+std::optional<std::size_t>
+tedit::Editor::findFrom(const std::size_t offset)
+{
+    auto const& query = m_search->query;
+
+    // Wraps around to the start of the document
+    auto found = m_buffer.find(query, offset);
+    if (!found && offset)
+    {
+        found = m_buffer.find(query, 0);
+    }
+
+    return found;
+}
+
+void
+tedit::Editor::showMatch()
+{
+    auto const& search = *m_search;
+
+    std::optional<std::size_t> target = search.matches.empty()
+        ? std::optional<std::size_t>(search.origin)
+        : search.matches.back();
+
+    // A query with no match leaves the cursor on the last one found
+    if (!target) return;
+
+    Position position = toPosition(*target);
+    m_cursor.setPosition(position.column, position.row);
+    invalidateLayout();
+}
+
+void
+tedit::Editor::replaceAll()
+{
+    if (m_replacer || m_pending_replace || m_asking) return;
+
+    using Replace = std::optional<std::pair<std::regex, std::string>>;
+
+    m_asking = m_workers.submit(WorkerPool::Priority::High,
+        [](const WorkerPool::Token& token) -> Replace
         {
-            m_clipboard += m_lines[i]->substr((i == min.row ? min.column : 0), (i == max.row ? max.column : m_lines[i]->size()), erase);
-            if (i != max.row) m_clipboard += '\n';
-        }
+            auto pattern = prompt("Replace regex", token);
+            if (!pattern || pattern->empty()) return std::nullopt;
+
+            auto format = prompt("Replace with", token);
+            if (!format) return std::nullopt;
 
-        if (erase)
+            // Compiling a long pattern takes a while too
+            try
+            {
+                return std::make_pair(std::regex(*pattern), std::move(*format));
+            }
+            catch (const std::regex_error&)
+            {
+                return std::nullopt;
+            }
+        },
+        [this](Replace replace)
         {
-            std::shared_ptr<Line> last = m_lines[max.row];
+            m_asking.reset();
 
-            for (std::size_t i = min.row + 1; i < max.row; ++i)
+            if (replace)
             {
-                m_lines.erase(m_lines.begin() + i);
+                startReplace(std::move(replace->first), std::move(replace->second));
             }
+        });
+}
 
-            m_lines[min.row]->combine(std::move(*last));
-            m_lines.erase(m_lines.begin() + max.row);
-            m_selected_end = m_selected_start = min;
-        }
-    }
-    else
+void
+tedit::Editor::startReplace(std::regex regex, std::string format)
+{
+    // The whole file is searched, not just what is loaded, update()
+    // starts it once the indexer is done
+    if (m_indexer)
     {
-        std::size_t min_column = std::min(m_selected_start.column, m_selected_end.column);
-        std::size_t max_column = std::max(m_selected_start.column, m_selected_end.column);
-        m_clipboard += m_lines[min.row]->substr(min_column, max_column - min_column, erase);
+        m_pending_replace.emplace(std::move(regex), std::move(format));
+        return;
     }
 
-    m_cursor.setPosition(std::min(min.column, max.column), min.row);
-    scrollToCursor();
+    m_replace_version = m_buffer.version();
+    m_replacer = std::make_unique<Replacer>(m_workers, m_buffer.snapshot(), std::move(regex), std::move(format));
 }
 
 void
-tedit::Editor::paste()
+tedit::Editor::finishReplace()
 {
-    for (auto const& c : m_clipboard)
+    auto matches = m_replacer->take();
+    std::size_t skipped = m_replacer->skipped();
+
+    // Edits made during the scan moved the text the matches point at,
+    // the text as it is now is searched again
+    if (m_buffer.version() != m_replace_version)
+    {
+        std::regex regex = m_replacer->regex();
+        std::string format = m_replacer->format();
+        m_replacer.reset();
+        startReplace(std::move(regex), std::move(format));
+        return;
+    }
+
+    m_replacer.reset();
+
+    m_notice = "Replaced " + std::to_string(matches.size()) + " matches";
+    if (skipped)
     {
-        write(c);
+        m_notice += ", skipped " + std::to_string(skipped) + " lines longer than "
+            + std::to_string(TEDIT_REPLACE_MAX_LINE) + " bytes";
     }
+
+    if (matches.empty()) return;
+
+    // Undone at once, and applied from the end so every offset is still
+    // the one it was found at
+    m_history.group();
+
+    for (auto it = matches.rbegin(); it != matches.rend(); ++it)
+    {
+        m_buffer.erase(it->offset, it->length);
+        m_buffer.insert(it->offset, it->replacement);
+    }
+
+    m_history.seal();
+    m_saved = false;
+
+    Position cursor = toPosition(std::min(toOffset(m_cursor.getPosition()), m_buffer.length()));
+    m_cursor.setPosition(cursor.column, cursor.row);
+    invalidateLayout(false);
+}
+
+std::optional<std::string>
+tedit::Editor::ask(const std::string& command, const WorkerPool::Token& token)
+{
+    int fds[2];
+    if (pipe2(fds, O_CLOEXEC) != 0) return std::nullopt;
+
+    pid_t pid = fork();
+    if (pid < 0)
+    {
+        close(fds[0]);
+        close(fds[1]);
+        return std::nullopt;
+    }
+
+    if (pid == 0)
+    {
+        // A group of its own, so the dialog the shell starts is killed with it
+        setpgid(0, 0);
+        dup2(fds[1], STDOUT_FILENO);
+        execl("/bin/sh", "sh", "-c", command.c_str(), static_cast<char*>(nullptr));
+        _exit(127);
+    }
+
+    close(fds[1]);
+
+    // Nothing would ever get to a worker stuck reading, and the window
+    // could not close while the dialog is open
+    std::string answer;
+    bool cancelled = false;
+    char buffer[1024];
+    pollfd output = { .fd = fds[0], .events = POLLIN, .revents = 0 };
+
+    while (true)
+    {
+        if (token.isCancelled())
+        {
+            kill(-pid, SIGTERM);
+            cancelled = true;
+            break;
+        }
+
+        int ready = poll(&output, 1, TEDIT_DIALOG_POLL);
+        if (ready < 0 && errno != EINTR) break;
+        if (ready <= 0) continue;
+
+        ssize_t count = read(fds[0], buffer, sizeof(buffer));
+        if (count < 0 && errno == EINTR) continue;
+        if (count <= 0) break;
+
+        answer.append(buffer, count);
+    }
+
+    close(fds[0]);
+
+    int status = 0;
+    while (waitpid(pid, &status, 0) < 0 && errno == EINTR);
+
+    // Cancelled, by the user or the job
+    if (cancelled || !WIFEXITED(status) || WEXITSTATUS(status) != 0) return std::nullopt;
+
+    if (!answer.empty() && answer.back() == '\n') answer.pop_back();
+    return answer;
+}
+
+std::optional<std::string>
+tedit::Editor::prompt(const std::string& text, const WorkerPool::Token& token)
+{
+    return ask("zenity --entry --text=\"" + text + "\"", token);
 }
 
 void
@@ -743,101 +1469,253 @@ tedit::Editor::save()
 {
     if (m_saved) return;
 
+    if (m_saving)
+    {
+        m_save_requested = true;
+        return;
+    }
+
     if (!m_filename)
     {
-        system("zenity --file-selection --save --confirm-overwrite > temp");
+        if (m_asking) return;
 
-        std::ifstream file("temp");
-        m_filename = "";
-        std::getline(file, *m_filename);
-        file.close();
-        remove("temp");
+        // Saved once a name is picked
+        m_asking = m_workers.submit(WorkerPool::Priority::High,
+            [](const WorkerPool::Token& token)
+            {
+                return ask("zenity --file-selection --save --confirm-overwrite", token);
+            },
+            [this](std::optional<std::string> filename)
+            {
+                m_asking.reset();
+                if (!filename || filename->empty()) return;
 
-        if (std::empty(*m_filename))
-        {
-            m_filename = std::nullopt;
-            return;
-        }
+                m_filename = std::move(*filename);
+                save();
+            });
+        return;
+    }
 
-        m_file = std::make_unique<std::fstream>(std::fstream());
+    if (m_journal)
+    {
+        m_journal->checkpoint();
     }
 
-    std::string strcontent = std::accumulate(m_lines.begin(), m_lines.end(),
-        std::string(),
-        [](std::string& acc, const std::shared_ptr<Line>& line) -> std::string
+    // The buffer may still be reading from a mapping of the old file,
+    // the snapshot replaces it with a new inode instead of truncating it
+    m_saving_version = m_buffer.version();
+    m_saving = m_workers.submit(WorkerPool::Priority::High,
+        [snapshot = m_buffer.snapshot(true), filename = *m_filename](const WorkerPool::Token&)
         {
-            return acc + line->content() + "\n";
+            return snapshot.write(filename);
+        },
+        [this](const bool written)
+        {
+            finishSave(written);
+
+            if (m_save_requested)
+            {
+                m_save_requested = false;
+                save();
+            }
         });
-    
-    m_file->open(m_filename.value(), std::ios::out | std::ios::trunc);
-    *m_file << strcontent;
-    m_file->close();
-    m_saved = true;
 }
 
 void
 tedit::Editor::open()
 {
-    char filename[1024];
-    FILE *f = popen("zenity --file-selection", "r");
-    fgets(filename, 1024, f);
-    
-    if (filename[0] != '\0' && filename[1] != '\0')
-    {
-        std::size_t size = strlen(filename);
-
-        if (filename[size - 1] == '\n') filename[size - 1] = '\0';
+    if (m_asking) return;
 
-        m_file = std::make_unique<std::fstream>(std::fstream(filename, std::ios::in));
-
-        if (!m_file->fail())
+    m_asking = m_workers.submit(WorkerPool::Priority::High,
+        [](const WorkerPool::Token& token)
+        {
+            return ask("zenity --file-selection", token);
+        },
+        [this](std::optional<std::string> filename)
         {
-            m_filename = filename;
-            m_lines.clear();
-            m_cursor.setPosition(0, 0);
+            m_asking.reset();
 
-            m_lines.push_back(std::shared_ptr<Line>(new Line("")));
-            for (std::string line; std::getline(*m_file, line);)
+            if (filename && !filename->empty())
             {
-                for (std::size_t i = 0; i < line.size(); ++i)
-                {
-                    write(line[i]);
-                }
-                
-                write('\n');
+                load(*filename);
             }
+        });
+}
+
+void
+tedit::Editor::load(const std::string& filename)
+{
+    auto mapping = MappedFile::open(filename);
+    if (!mapping) return;
+
+    // What was requested was for the old file
+    m_save_requested = false;
+    waitForSave();
+
+    if (m_journal && m_saved)
+    {
+        m_journal->discard();
+    }
+
+    m_filename = filename;
+    m_search.reset();
+    m_replacer.reset();
+    m_pending_replace.reset();
+    m_notice.clear();
+    m_truncated = false;
+    m_indexer.reset();
 
-            m_cursor.setPosition(0, 0);
+    if (m_highlighting)
+    {
+        m_highlighting->cancel();
+        m_highlighting.reset();
+    }
+
+    m_buffer = PieceTable(mapping, false);
+    m_indexer = std::make_unique<LineIndexer>(std::move(mapping), m_workers);
+    m_journal.reset();
+    m_hmax = 0;
+
+    // Edits left by a crash are replayed on the whole file
+    if (Journal::exists(filename))
+    {
+        loadChunks(true);
+    }
+
+    m_journal = Journal::open(filename, &m_buffer);
+    m_buffer.attach(m_journal.get());
+
+    if (m_journal && m_journal->stale())
+    {
+        m_notice = "Edits made on another version of the file were kept in " + *m_journal->stale();
+    }
+
+    // Recovered edits are part of the file, not undone
+    m_history.clear();
+    m_buffer.attach(&m_history);
+
+    // Only the lines loaded so far are lexed, those still coming in are
+    // told about as they are appended
+    m_highlight = isSource(filename);
+    m_highlighter.clear();
+    if (m_highlight) m_buffer.attach(&m_highlighter);
+    m_saved = m_buffer.version() == 0;
+    m_cursor.setPosition(0, 0);
+    invalidateLayout();
+}
+
+void
+tedit::Editor::finishSave(const bool written)
+{
+    m_saving.reset();
+
+    // Edits made while writing are not on disk yet
+    m_saved = written && m_saving_version == m_buffer.version();
+
+    if (m_journal)
+    {
+        written ? m_journal->rebase() : m_journal->cancel();
+    }
+    else if (written)
+    {
+        m_journal = Journal::open(*m_filename);
+        m_buffer.attach(m_journal.get());
+
+        if (m_journal && m_journal->stale())
+        {
+            m_notice = "Edits made on another version of the file were kept in " + *m_journal->stale();
         }
-        
-        m_file->close();
+    }
+}
+
+void
+tedit::Editor::waitForSave()
+{
+    // The completion of the save is what clears m_saving, and it may
+    // start the next one
+    while (m_saving)
+    {
+        m_workers.wait(*m_saving);
+        m_workers.dispatch();
+    }
+}
+
+void
+tedit::Editor::loadChunks(const bool wait)
+{
+    if (!m_indexer) return;
+
+    auto chunks = wait ? m_indexer->wait() : m_indexer->poll();
+    for (auto const& chunk : chunks)
+    {
+        m_buffer.appendOriginal(chunk.end, chunk.line_feeds, chunk.non_ascii);
+    }
+
+    if (!m_buffer.isLoading())
+    {
+        m_indexer.reset();
+    }
+
+    if (!chunks.empty())
+    {
+        invalidateLayout(false);
     }
 }
 
 void
 tedit::Editor::handleMouseScrolling(const int mouseX, const int mouseY)
 {
+    // A pixel of the thumb is thousands of rows on a huge file, with
+    // shift held every pixel the pointer moves is one row or column
+    bool fine = sf::Keyboard::isKeyPressed(sf::Keyboard::LShift)
+        || sf::Keyboard::isKeyPressed(sf::Keyboard::RShift);
+
+    auto step = [fine](const double size, const std::size_t max)
+    {
+        return fine && max ? size / max : 0.0;
+    };
+
     // Vertical Scrolling
     {
-        auto scrolled = m_vscroller.mouseScroll(mouseX, mouseY);
+        std::size_t max = maxScroll(Scroller::Vertical);
+        auto scrolled = m_vscroller.mouseScroll(mouseX, mouseY, step(s_default_font.size, max));
         if (scrolled)
         {
-            std::size_t total = (m_lines.size() * s_default_font.size) - m_shape.getSize().y + (TEDIT_SCROLL_SIZE * 2);
-            m_vscrolled = scrolled.value() * total / 100;
+            m_vscrolled = std::llround(scrolled.value() * max);
         }
     }
 
     // Horizontal Scrolling
     {
-        auto scrolled = m_hscroller.mouseScroll(mouseX, mouseY);
+        std::size_t max = maxScroll(Scroller::Horizontal);
+        auto scrolled = m_hscroller.mouseScroll(mouseX, mouseY, step(s_default_font.glyph, max));
         if (scrolled)
         {
-            std::size_t total = (m_hmax * s_default_font.glyph) - m_shape.getSize().x + (TEDIT_SCROLL_SIZE * 2);
-            m_hscrolled = scrolled.value() * total / 100;
+            m_hscrolled = std::llround(scrolled.value() * max);
         }
     }
 }
 
+void
+tedit::Editor::handleMouseWheel(const sf::Event::MouseWheelScrollEvent& event)
+{
+    // Only the offsets move, nothing has to be laid out again
+    if (event.wheel == sf::Mouse::VerticalWheel)
+    {
+        double rows = -event.delta * TEDIT_WHEEL_LINES;
+        double scrolled = m_vscrolled + rows * s_default_font.size;
+        m_vscrolled = static_cast<std::size_t>(std::clamp(scrolled, 0.0, static_cast<double>(maxScroll(Scroller::Vertical))));
+    }
+    else
+    {
+        double columns = -event.delta * TEDIT_WHEEL_LINES;
+        double scrolled = m_hscrolled + columns * s_default_font.glyph;
+        m_hscrolled = static_cast<std::size_t>(std::clamp(scrolled, 0.0, static_cast<double>(maxScroll(Scroller::Horizontal))));
+    }
+
+    syncScrollers();
+}
+
 void
 tedit::Editor::scrollToCursor()
 {
@@ -851,12 +1729,12 @@ tedit::Editor::scrollToCursor()
         }
         else if (((position.row + 1) * s_default_font.size) > m_vscrolled + m_size.y)
         {
-            m_vscrolled = (position.row + 1 - ((float)m_size.y / s_default_font.size))
-                            * s_default_font.size
+            m_vscrolled = (position.row + 1) * s_default_font.size
+                            - static_cast<std::size_t>(m_size.y)
                             + (TEDIT_SCROLL_SIZE * 2);
         }
 
-        m_vscroller.scrollTo(position.row * 100 / (getLinesCount() + 1));
+        m_vscrolled = std::min(m_vscrolled, maxScroll(Scroller::Vertical));
     }
 
     // Horizontal Scrolling
@@ -868,25 +1746,52 @@ tedit::Editor::scrollToCursor()
         }
         else if (((position.column + 1) * char_width) > m_hscrolled + m_size.x)
         {
-            m_hscrolled = (position.column + 1 - ((float)m_size.x / char_width)) * char_width;
+            m_hscrolled = (position.column + 1) * static_cast<double>(char_width) - m_size.x;
         }
 
-        m_hscroller.scrollTo(position.column * 100 / (m_hmax + 1));
+        m_hscrolled = std::min(m_hscrolled, maxScroll(Scroller::Horizontal));
     }
+
+    syncScrollers();
 }
 
 void
-tedit::Editor::resizeScroller()
+tedit::Editor::syncScrollers()
+{
+    std::size_t vmax = maxScroll(Scroller::Vertical);
+    std::size_t hmax = maxScroll(Scroller::Horizontal);
+
+    m_vscroller.scrollTo(vmax ? static_cast<double>(m_vscrolled) / vmax : 0.0);
+    m_hscroller.scrollTo(hmax ? static_cast<double>(m_hscrolled) / hmax : 0.0);
+}
+
+std::size_t
+tedit::Editor::maxScroll(const Scroller::Direction direction)
+const noexcept
+{
+    std::size_t content = direction == Scroller::Vertical
+        ? getLinesCount() * s_default_font.size
+        : static_cast<std::size_t>(m_hmax * static_cast<double>(s_default_font.glyph));
+    std::size_t viewport = direction == Scroller::Vertical
+        ? m_shape.getSize().y
+        : m_shape.getSize().x;
+
+    content += TEDIT_SCROLL_SIZE * 2;
+    return content > viewport ? content - viewport : 0;
+}
+
+void
+tedit::Editor::resizeScroller(const bool follow_cursor)
 {
     auto size = getSize();
 
     // Vertical Scrolling
     {
-        auto scroll_size = (static_cast<float>(size.y) / s_default_font.size) / m_lines.size();
+        auto scroll_size = (static_cast<float>(size.y) / s_default_font.size) / getLinesCount();
 
         if (scroll_size < 1)
         {
-            m_vscroller.setSize(size.y, TEDIT_SCROLL_SIZE, scroll_size * size.y);
+            m_vscroller.setSize(size.y, TEDIT_SCROLL_SIZE, std::max(scroll_size * size.y, TEDIT_SCROLL_MIN_THUMB * 1.0f));
         }
         else
         {
@@ -900,7 +1805,7 @@ tedit::Editor::resizeScroller()
 
         if (scroll_size < 1)
         {
-            m_hscroller.setSize(size.x, scroll_size * size.x, TEDIT_SCROLL_SIZE);
+            m_hscroller.setSize(size.x, std::max(scroll_size * size.x, TEDIT_SCROLL_MIN_THUMB * 1.0f), TEDIT_SCROLL_SIZE);
         }
         else
         {
@@ -908,7 +1813,14 @@ tedit::Editor::resizeScroller()
         }
     }
 
-    scrollToCursor();
+    if (follow_cursor)
+    {
+        scrollToCursor();
+    }
+    else
+    {
+        syncScrollers();
+    }
 }
 
 void
@@ -917,4 +1829,11 @@ tedit::Editor::setFont(const std::string& font_path)
     s_default_font.font.loadFromFile(font_path);
     s_default_font.glyph = s_default_font.font.getGlyph(' ', s_default_font.size, s_default_font.bold).advance;
 }
+
+const tedit::Editor::Font&
+tedit::Editor::getFont()
+noexcept
+{
+    return s_default_font;
+}
 #pragma endregion // tedit::Editor
\ No newline at end of file
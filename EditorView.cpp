@@ -0,0 +1,254 @@
+#include "includes/EditorView.hpp"
+
+#pragma region tedit::EditorView
+tedit::EditorView::EditorView(const sf::Font& font, const unsigned int size, const float glyph, const bool bold)
+    : m_size(size),
+      m_overlay(font, size, glyph, bold),
+      m_text(font, size, glyph, bold),
+      m_status(font, size, glyph, bold),
+      m_tile_size(0, 0),
+      m_loading(false)
+{
+    m_progress.setFillColor(sf::Color(86, 156, 214));
+}
+
+void
+tedit::EditorView::setState(const State& state)
+{
+    m_background = state.background;
+    m_cursor = state.cursor;
+    m_vscroller = state.vscroller;
+    m_hscroller = state.hscroller;
+
+    m_scroll = sf::Transform(
+                            1, 0, -1.0f * state.hscrolled,
+                            0, 1, -1.0f * state.vscrolled,
+                            0, 0, 1);
+
+    m_overlay.clear();
+
+    for (auto const& selected : state.selection)
+    {
+        m_overlay.addRectangle(selected, sf::Color(120, 120, 120, 200));
+    }
+
+    // Every tile is as wide as the window, a resize throws them all away
+    sf::Vector2u tile_size(static_cast<unsigned int>(state.background.getSize().x),
+                           TEDIT_TILE_ROWS * m_size);
+    if (tile_size != m_tile_size)
+    {
+        m_tiles.clear();
+        m_spare.clear();
+        m_tile_size = tile_size;
+    }
+
+    // Scrolling only rasterizes the tiles that just came into view
+    m_visible.clear();
+
+    std::size_t first = state.first_row / TEDIT_TILE_ROWS;
+    std::size_t count = (state.rows.size() + TEDIT_TILE_ROWS - 1) / TEDIT_TILE_ROWS;
+
+    for (std::size_t i = 0; i < count; ++i)
+    {
+        m_visible.emplace_back(&tile(state, first + i), static_cast<float>(m_size) * TEDIT_TILE_ROWS * i);
+    }
+
+    trim(first, first + count);
+
+    m_loading = state.progress >= 0;
+    m_progress.setSize(sf::Vector2f(state.background.getSize().x * state.progress, 2));
+
+    m_status.clear();
+
+    if (!state.status.empty())
+    {
+        auto size = state.background.getSize();
+        float height = m_size * 1.2f;
+
+        m_status.addRectangle(sf::FloatRect(0, size.y - height, size.x, height), sf::Color(45, 45, 45));
+        m_status.addText(state.status, m_size * 0.2f, size.y - height, sf::Color::White);
+    }
+}
+
+void
+tedit::EditorView::draw(sf::RenderTarget& target, sf::RenderStates states)
+const
+{
+    target.draw(m_background, states);
+
+    sf::Transform old = states.transform;
+    states.transform *= m_scroll;
+
+    target.draw(m_overlay, states);
+
+    // Tiles hold premultiplied colors, see rasterize
+    sf::RenderStates tile_states = states;
+    tile_states.blendMode = sf::BlendMode(sf::BlendMode::One, sf::BlendMode::OneMinusSrcAlpha);
+
+    for (auto const& [tile, y] : m_visible)
+    {
+        sf::Sprite sprite(tile->texture->getTexture());
+        sprite.setPosition(0, y);
+        target.draw(sprite, tile_states);
+    }
+
+    target.draw(m_cursor, states);
+    states.transform = old;
+
+    target.draw(m_vscroller, states);
+    target.draw(m_hscroller, states);
+
+    if (m_loading)
+    {
+        target.draw(m_progress, states);
+    }
+
+    target.draw(m_status, states);
+}
+
+const tedit::EditorView::Tile&
+tedit::EditorView::tile(const State& state, const std::size_t index)
+{
+    std::size_t begin = index * TEDIT_TILE_ROWS - state.first_row;
+    std::size_t end = std::min(begin + TEDIT_TILE_ROWS, state.rows.size());
+
+    auto found = m_tiles.find(index);
+    if (found != m_tiles.end())
+    {
+        Tile& cached = found->second;
+
+        if (cached.first_column == state.first_column
+            && cached.non_ascii == state.non_ascii
+            && std::equal(cached.rows.begin(), cached.rows.end(),
+                          state.rows.begin() + begin, state.rows.begin() + end)
+            && std::equal(cached.kinds.begin(), cached.kinds.end(),
+                          state.kinds.begin() + begin, state.kinds.begin() + end))
+        {
+            return cached;
+        }
+    }
+    else
+    {
+        Tile fresh =
+        {
+            .texture      = takeTexture(),
+            .first_column = 0,
+            .non_ascii    = false,
+            .rows         = {},
+            .kinds        = {},
+        };
+        found = m_tiles.emplace(index, std::move(fresh)).first;
+    }
+
+    // Edited, scrolled sideways or never drawn
+    Tile& stale = found->second;
+    stale.first_column = state.first_column;
+    stale.non_ascii = state.non_ascii;
+    stale.rows.assign(state.rows.begin() + begin, state.rows.begin() + end);
+    stale.kinds.assign(state.kinds.begin() + begin, state.kinds.begin() + end);
+    rasterize(stale);
+
+    return stale;
+}
+
+std::unique_ptr<sf::RenderTexture>
+tedit::EditorView::takeTexture()
+{
+    // Creating a texture is slow, the ones of tiles that were let go
+    // are drawn over instead
+    if (!m_spare.empty())
+    {
+        auto texture = std::move(m_spare.back());
+        m_spare.pop_back();
+        return texture;
+    }
+
+    auto texture = std::make_unique<sf::RenderTexture>();
+    texture->create(m_tile_size.x, m_tile_size.y);
+    return texture;
+}
+
+void
+tedit::EditorView::trim(const std::size_t first, const std::size_t last)
+{
+    auto const distance = [first, last](const std::size_t index)
+    {
+        return index < first ? first - index : index >= last ? index - last + 1 : 0;
+    };
+
+    // Lets go of the tiles furthest from the view, never of one on screen
+    while (m_tiles.size() > TEDIT_TILE_CACHE)
+    {
+        auto furthest = std::max_element(m_tiles.begin(), m_tiles.end(),
+            [&](auto const& a, auto const& b)
+            {
+                return distance(a.first) < distance(b.first);
+            });
+
+        if (distance(furthest->first) == 0) break;
+
+        m_spare.push_back(std::move(furthest->second.texture));
+        m_tiles.erase(furthest);
+    }
+}
+
+void
+tedit::EditorView::rasterize(Tile& tile)
+{
+    m_text.clear();
+
+    for (std::size_t i = 0; i < tile.rows.size(); ++i)
+    {
+        auto const& content = tile.rows[i];
+        auto const& kinds = tile.kinds[i];
+        if (content.empty()) continue;
+
+        sf::String text = tile.non_ascii
+            ? sf::String::fromUtf8(content.begin(), content.end())
+            : sf::String(content);
+        float y = static_cast<float>(m_size) * i;
+
+        if (kinds.empty())
+        {
+            m_text.addText(text, 0, y, sf::Color::White);
+            continue;
+        }
+
+        // Kinds are per byte, a character takes the kind of its first one
+        m_colors.clear();
+        for (std::size_t byte = 0; byte < content.size() && byte < kinds.size(); ++byte)
+        {
+            if ((static_cast<unsigned char>(content[byte]) & 0xC0) != 0x80)
+            {
+                m_colors.push_back(colorOf(kinds[byte]));
+            }
+        }
+
+        m_text.addText(text, 0, y, m_colors);
+    }
+
+    // Blending onto a transparent texture leaves the colors multiplied
+    // by their alpha, which is why the tiles are drawn with One
+    tile.texture->clear(sf::Color::Transparent);
+    tile.texture->draw(m_text);
+    tile.texture->display();
+}
+
+sf::Color
+tedit::EditorView::colorOf(const Highlighter::Kind kind)
+noexcept
+{
+    switch (kind)
+    {
+    case Highlighter::Kind::Keyword:      return sf::Color(86, 156, 214);
+    case Highlighter::Kind::Type:         return sf::Color(78, 201, 176);
+    case Highlighter::Kind::Number:       return sf::Color(181, 206, 168);
+    case Highlighter::Kind::String:       return sf::Color(206, 145, 120);
+    case Highlighter::Kind::Comment:      return sf::Color(106, 153, 85);
+    case Highlighter::Kind::Preprocessor: return sf::Color(197, 134, 192);
+    case Highlighter::Kind::Text:         break;
+    }
+
+    return sf::Color::White;
+}
+#pragma endregion // tedit::EditorView
\ No newline at end of file
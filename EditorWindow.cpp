@@ -1,7 +1,8 @@
 #include "includes/EditorWindow.hpp"
 
 tedit::EditorWindow::EditorWindow(const std::size_t& width, const std::size_t& height)
-    : m_window(sf::VideoMode(width, height), WINDOW_TITLE)
+    : m_window(sf::VideoMode(width, height), WINDOW_TITLE),
+      m_rendering(false)
 {
     tedit::Editor::setFont("assets/monospace.ttf");
 }
@@ -10,36 +11,197 @@ int
 tedit::EditorWindow::open()
 {
     auto [width, height] = m_window.getSize();
-    tedit::Editor editor(width, height);
+    tedit::Editor editor(m_workers, width, height);
+
+    startRendering();
 
     while (m_window.isOpen())
     {
         handleEvents(editor);
+        editor.update();
+        editor.layout();
 
-        m_window.clear();
+        if (editor.isDirty())
+        {
+            publish(editor);
+            editor.clearDamage();
+        }
+    }
+
+    stopRendering();
+
+    return 0;
+}
+
+void
+tedit::EditorWindow::render()
+{
+    m_window.setActive(true);
+
+    auto const& font = tedit::Editor::getFont();
+    tedit::EditorView view(font.font, font.size, font.glyph, font.bold);
+    sf::Vector2f size = m_window.getView().getSize();
+
+    while (true)
+    {
+        {
+            std::unique_lock<std::mutex> lock(m_wake_mutex);
+            m_wake.wait(lock, [this] { return m_frames.hasFresh() || !m_rendering; });
+        }
+
+        if (!m_rendering) break;
 
-        m_window.draw(editor);
+        m_frames.fetch();
+        auto const& state = m_frames.front();
+
+        if (state.background.getSize() != size)
+        {
+            size = state.background.getSize();
+            m_window.setView(sf::View(sf::FloatRect(0, 0, size.x, size.y)));
+        }
+
+        view.setState(state);
+
+        m_window.clear();
+        m_window.draw(view);
         m_window.display();
     }
 
-    return 0;
+    m_window.setActive(false);
+}
+
+void
+tedit::EditorWindow::startRendering()
+{
+    // The context can only be active on one thread at a time
+    m_window.setActive(false);
+    m_rendering = true;
+    m_renderer = std::thread(&EditorWindow::render, this);
+}
+
+void
+tedit::EditorWindow::stopRendering()
+{
+    {
+        std::lock_guard<std::mutex> lock(m_wake_mutex);
+        m_rendering = false;
+    }
+    m_wake.notify_one();
+
+    if (m_renderer.joinable())
+    {
+        m_renderer.join();
+    }
+}
+
+void
+tedit::EditorWindow::publish(const Editor& editor)
+{
+    editor.snapshot(m_frames.back());
+    m_frames.publish();
+
+    // Taking the lock keeps the wakeup from landing between the renderer
+    // checking for a frame and going to sleep
+    {
+        std::lock_guard<std::mutex> lock(m_wake_mutex);
+    }
+    m_wake.notify_one();
 }
 
 void
 tedit::EditorWindow::handleEvents(Editor& editor)
 {
     sf::Event event;
+    std::vector<sf::Event> events;
+
+    // Sleep until something happens, unless there is background work to
+    // check on
+    bool received = editor.isBusy()
+        ? m_window.pollEvent(event)
+        : m_window.waitEvent(event);
+
+    // Then take everything that piled up, not just one event per frame
+    while (received)
+    {
+        events.push_back(event);
+        received = m_window.pollEvent(event);
+    }
 
-    if (m_window.pollEvent(event))
+    if (events.empty() && editor.isBusy())
     {
+        sf::sleep(sf::milliseconds(WINDOW_BUSY_INTERVAL));
+    }
+
+    dispatch(editor, events);
+}
+
+void
+tedit::EditorWindow::dispatch(Editor& editor, const std::vector<sf::Event>& events)
+{
+    std::size_t i = 0;
+
+    while (i < events.size())
+    {
+        if (events[i].type == sf::Event::EventType::TextEntered
+            && editor.getCurrentMode() == tedit::Editor::Mode::Insert)
+        {
+            // Plain key presses and releases do nothing in insert mode, they
+            // do not break up a run of text
+            std::string text;
+            for (; i < events.size(); ++i)
+            {
+                const sf::Event& next = events[i];
+
+                if (next.type == sf::Event::EventType::TextEntered)
+                {
+                    text += static_cast<char>(next.text.unicode);
+                }
+                else if ((next.type != sf::Event::EventType::KeyPressed
+                        && next.type != sf::Event::EventType::KeyReleased)
+                    || next.key.control)
+                {
+                    break;
+                }
+            }
+
+            editor.handleText(text);
+            continue;
+        }
+
+        // Only where the mouse ended up matters
+        if (events[i].type == sf::Event::EventType::MouseMoved)
+        {
+            while (i + 1 < events.size() && events[i + 1].type == sf::Event::EventType::MouseMoved)
+            {
+                ++i;
+            }
+        }
+
+        // A burst of wheel notches scrolls once, by all of them
+        if (events[i].type == sf::Event::EventType::MouseWheelScrolled)
+        {
+            sf::Event wheel = events[i++];
+            while (i < events.size()
+                && events[i].type == sf::Event::EventType::MouseWheelScrolled
+                && events[i].mouseWheelScroll.wheel == wheel.mouseWheelScroll.wheel)
+            {
+                wheel.mouseWheelScroll.delta += events[i++].mouseWheelScroll.delta;
+            }
+
+            editor.handleEvent(wheel);
+            continue;
+        }
+
+        const sf::Event& event = events[i++];
+
         if (event.type == sf::Event::EventType::Closed)
         {
+            stopRendering();
             m_window.close();
         }
         else if (event.type == sf::Event::EventType::Resized)
         {
-            sf::View fixedView(sf::FloatRect(0, 0, event.size.width, event.size.height));
-            m_window.setView(fixedView);
+            // The renderer moves the view once it gets a frame of the new size
             editor.setSize(event.size.width, event.size.height);
         }
 
@@ -0,0 +1,138 @@
+#include "includes/GapBuffer.hpp"
+
+#pragma region tedit::GapBuffer
+tedit::GapBuffer::GapBuffer()
+    : m_gap_begin(0),
+      m_gap_end(0)
+{
+}
+
+tedit::GapBuffer::GapBuffer(const std::string_view content)
+    : m_data(content.size() + TEDIT_GAP_MIN_SIZE),
+      m_gap_begin(content.size()),
+      m_gap_end(m_data.size())
+{
+    std::memcpy(m_data.data(), content.data(), content.size());
+}
+
+void
+tedit::GapBuffer::insert(const std::size_t index, const std::string_view text)
+{
+    if (index > size())
+    {
+        throw std::out_of_range("tedit::GapBuffer::insert");
+    }
+
+    moveGap(index);
+    reserve(text.size());
+
+    std::memcpy(m_data.data() + m_gap_begin, text.data(), text.size());
+    m_gap_begin += text.size();
+}
+
+void
+tedit::GapBuffer::erase(const std::size_t index, const std::size_t length)
+{
+    if (index + length > size())
+    {
+        throw std::out_of_range("tedit::GapBuffer::erase");
+    }
+
+    moveGap(index);
+    m_gap_end += length;
+}
+
+char
+tedit::GapBuffer::operator[](const std::size_t index)
+const noexcept
+{
+    return index < m_gap_begin
+        ? m_data[index]
+        : m_data[index + gapSize()];
+}
+
+std::string
+tedit::GapBuffer::substr(const std::size_t index, const std::size_t length)
+const
+{
+    std::size_t begin = std::min(index, size());
+    std::size_t end = std::min(index + length, size());
+
+    std::string result;
+    result.reserve(end - begin);
+
+    if (begin < m_gap_begin)
+    {
+        result.append(m_data.data() + begin, std::min(end, m_gap_begin) - begin);
+    }
+
+    if (end > m_gap_begin)
+    {
+        std::size_t from = std::max(begin, m_gap_begin) + gapSize();
+        result.append(m_data.data() + from, end + gapSize() - from);
+    }
+
+    return result;
+}
+
+std::size_t
+tedit::GapBuffer::size()
+const noexcept
+{
+    return m_data.size() - gapSize();
+}
+
+bool
+tedit::GapBuffer::empty()
+const noexcept
+{
+    return size() == 0;
+}
+
+std::size_t
+tedit::GapBuffer::capacity()
+const noexcept
+{
+    return m_data.capacity();
+}
+
+std::size_t
+tedit::GapBuffer::gapSize()
+const noexcept
+{
+    return m_gap_end - m_gap_begin;
+}
+
+void
+tedit::GapBuffer::moveGap(const std::size_t index)
+{
+    if (index < m_gap_begin)
+    {
+        std::size_t n = m_gap_begin - index;
+        std::memmove(m_data.data() + m_gap_end - n, m_data.data() + index, n);
+        m_gap_begin -= n;
+        m_gap_end -= n;
+    }
+    else if (index > m_gap_begin)
+    {
+        std::size_t n = index - m_gap_begin;
+        std::memmove(m_data.data() + m_gap_begin, m_data.data() + m_gap_end, n);
+        m_gap_begin += n;
+        m_gap_end += n;
+    }
+}
+
+void
+tedit::GapBuffer::reserve(const std::size_t length)
+{
+    if (gapSize() >= length) return;
+
+    // Grow geometrically so typing stays amortized O(1)
+    std::size_t grow = std::max({ length, m_data.size(), static_cast<std::size_t>(TEDIT_GAP_MIN_SIZE) });
+    std::size_t tail = m_data.size() - m_gap_end;
+
+    m_data.resize(m_data.size() + grow);
+    std::memmove(m_data.data() + m_data.size() - tail, m_data.data() + m_gap_end, tail);
+    m_gap_end = m_data.size() - tail;
+}
+#pragma endregion // tedit::GapBuffer
\ No newline at end of file
@@ -0,0 +1,426 @@
+#include "includes/Highlighter.hpp"
+
+#pragma region tedit::Highlighter
+tedit::Highlighter::Highlighter()
+    : m_first_dirty(0),
+      m_generation(0)
+{
+}
+
+void
+tedit::Highlighter::insert(const std::size_t row, const std::size_t lines)
+{
+    ++m_generation;
+    if (row >= m_states.size()) return;
+
+    // The last of the lines ends where the one edited used to, so it
+    // keeps its state to be compared against
+    m_states.insert(m_states.begin() + row, lines, State::Code);
+    m_dirty.insert(m_dirty.begin() + row, lines, 1);
+    m_dirty[row + lines] = 1;
+
+    m_first_dirty = std::min(m_first_dirty, row);
+}
+
+void
+tedit::Highlighter::erase(const std::size_t row, const std::size_t lines)
+{
+    ++m_generation;
+    if (row >= m_states.size()) return;
+
+    m_first_dirty = std::min(m_first_dirty, row);
+
+    // The line left ends where one that was never lexed did
+    if (row + lines >= m_states.size())
+    {
+        m_states.resize(row);
+        m_dirty.resize(row);
+        return;
+    }
+
+    m_states.erase(m_states.begin() + row, m_states.begin() + row + lines);
+    m_dirty.erase(m_dirty.begin() + row, m_dirty.begin() + row + lines);
+    m_dirty[row] = 1;
+}
+
+void
+tedit::Highlighter::clear()
+noexcept
+{
+    m_states.clear();
+    m_dirty.clear();
+    m_first_dirty = 0;
+    ++m_generation;
+}
+
+std::pair<std::size_t, std::size_t>
+tedit::Highlighter::relex(const PieceTable& buffer, const std::size_t last_row, const std::size_t budget)
+{
+    std::size_t end = std::min(last_row, buffer.getLinesCount());
+    std::size_t row = std::min(m_first_dirty, m_states.size());
+    std::pair<std::size_t, std::size_t> changed(end, 0);
+
+    for (std::size_t lexed = 0; row < end && lexed < budget; ++lexed)
+    {
+        if (row < m_states.size() && !m_dirty[row])
+        {
+            row = nextDirty(row);
+            if (row >= end) break;
+        }
+
+        std::size_t length = std::min<std::size_t>(buffer.lineLength(row), TEDIT_HIGHLIGHT_MAX_LINE + 1);
+        State state = lex(buffer.substr(buffer.lineOffset(row), length), stateAt(row));
+
+        if (row == m_states.size())
+        {
+            m_states.push_back(state);
+            m_dirty.push_back(0);
+        }
+        else
+        {
+            // The next line starts differently, it has to be lexed too
+            if (m_states[row] != state && row + 1 < m_states.size())
+            {
+                m_dirty[row + 1] = 1;
+            }
+
+            m_states[row] = state;
+            m_dirty[row] = 0;
+        }
+
+        changed.first = std::min(changed.first, row);
+        changed.second = row + 2;
+        ++row;
+    }
+
+    m_first_dirty = row;
+    return changed;
+}
+
+bool
+tedit::Highlighter::prepare(const PieceTable& buffer, Job& job)
+const
+{
+    std::size_t row = nextDirty(std::min(m_first_dirty, m_states.size()));
+    if (row >= buffer.getLinesCount()) return false;
+
+    std::size_t window = std::min<std::size_t>(m_states.size() - row, TEDIT_HIGHLIGHT_WINDOW);
+
+    job.row = row;
+    job.offset = buffer.lineOffset(row);
+    job.start = stateAt(row);
+    job.generation = m_generation;
+    job.cached.assign(m_states.begin() + row, m_states.begin() + row + window);
+    job.dirty.assign(m_dirty.begin() + row, m_dirty.begin() + row + window);
+    job.states.clear();
+
+    return true;
+}
+
+void
+tedit::Highlighter::run(const PieceTable::Snapshot& snapshot, Job& job)
+{
+    std::size_t position = job.offset;
+    std::size_t lexed = 0;
+    State state = job.start;
+
+    for (std::size_t i = 0; lexed < TEDIT_HIGHLIGHT_JOB; ++i)
+    {
+        std::size_t end = snapshot.find('\n', position);
+        std::size_t length = std::min<std::size_t>(end - position, TEDIT_HIGHLIGHT_MAX_LINE + 1);
+
+        state = lex(snapshot.substr(position, length), state);
+        job.states.push_back(state);
+
+        if (end >= snapshot.length()) break;
+
+        // Ends as it did before and the line after was not edited, so
+        // nothing further down changes
+        if (i + 1 < job.cached.size() && state == job.cached[i] && !job.dirty[i + 1]) break;
+
+        lexed += end - position + 1;
+        position = end + 1;
+    }
+}
+
+std::pair<std::size_t, std::size_t>
+tedit::Highlighter::merge(const Job& job)
+{
+    if (job.generation != m_generation || job.row > m_states.size() || job.states.empty())
+    {
+        return { 0, 0 };
+    }
+
+    std::size_t row = job.row;
+    bool moved = false; // The last line ends differently than it did
+
+    for (State state : job.states)
+    {
+        if (row == m_states.size())
+        {
+            m_states.push_back(state);
+            m_dirty.push_back(0);
+            moved = false;
+        }
+        else
+        {
+            moved = m_states[row] != state;
+            m_states[row] = state;
+            m_dirty[row] = 0;
+        }
+
+        ++row;
+    }
+
+    if (moved && row < m_states.size())
+    {
+        m_dirty[row] = 1;
+    }
+
+    return { job.row, row + 1 };
+}
+
+tedit::Highlighter::State
+tedit::Highlighter::stateAt(const std::size_t row)
+const noexcept
+{
+    return row && row - 1 < m_states.size()
+        ? m_states[row - 1]
+        : State::Code;
+}
+
+tedit::Highlighter::State
+tedit::Highlighter::lex(const std::string_view line, const State start, Kind* kinds)
+{
+    std::size_t size = line.size();
+
+    auto const mark = [kinds](const std::size_t begin, const std::size_t end, const Kind kind)
+    {
+        if (kinds) std::fill(kinds + begin, kinds + end, kind);
+    };
+
+    // Too slow to lex on every keystroke, and not code anyone reads
+    if (size > TEDIT_HIGHLIGHT_MAX_LINE)
+    {
+        mark(0, size, Kind::Text);
+        return start;
+    }
+
+    // A backslash at the very end joins the next line to this one
+    bool continued = size && line.back() == '\\';
+
+    // Index past the closing quote, npos when the line ends first
+    auto const quoted = [&line, size](const std::size_t from, const char quote)
+    {
+        for (std::size_t i = from; i < size; ++i)
+        {
+            if (line[i] == '\\') ++i;
+            else if (line[i] == quote) return i + 1;
+        }
+
+        return std::string_view::npos;
+    };
+
+    auto const word = [](const char c)
+    {
+        return std::isalnum(static_cast<unsigned char>(c)) || c == '_';
+    };
+
+    std::size_t i = 0;
+
+    switch (start)
+    {
+    case State::Code: break;
+    case State::LineComment:
+        {
+            mark(0, size, Kind::Comment);
+            return continued ? State::LineComment : State::Code;
+        }
+    case State::BlockComment:
+        {
+            std::size_t close = line.find("*/");
+            if (close == std::string_view::npos)
+            {
+                mark(0, size, Kind::Comment);
+                return State::BlockComment;
+            }
+
+            mark(0, close + 2, Kind::Comment);
+            i = close + 2;
+        }
+        break;
+    case State::String:
+        {
+            std::size_t close = quoted(0, '"');
+            if (close == std::string_view::npos)
+            {
+                mark(0, size, Kind::String);
+                return continued ? State::String : State::Code;
+            }
+
+            mark(0, close, Kind::String);
+            i = close;
+        }
+        break;
+    }
+
+    // Only blanks before it on the line
+    bool directive = start == State::Code;
+
+    while (i < size)
+    {
+        char c = line[i];
+        char next = i + 1 < size ? line[i + 1] : '\0';
+
+        if (c == ' ' || c == '\t')
+        {
+            mark(i, i + 1, Kind::Text);
+            ++i;
+            continue;
+        }
+
+        if (c == '#' && directive)
+        {
+            std::size_t end = i + 1;
+            while (end < size && (line[end] == ' ' || line[end] == '\t')) ++end;
+
+            std::size_t name = end;
+            while (end < size && word(line[end])) ++end;
+
+            mark(i, end, Kind::Preprocessor);
+            bool include = line.substr(name, end - name) == "include";
+            directive = false;
+            i = end;
+
+            if (include)
+            {
+                while (i < size && (line[i] == ' ' || line[i] == '\t'))
+                {
+                    mark(i, i + 1, Kind::Text);
+                    ++i;
+                }
+
+                if (i < size && line[i] == '<')
+                {
+                    std::size_t close = line.find('>', i);
+                    end = close == std::string_view::npos ? size : close + 1;
+                    mark(i, end, Kind::String);
+                    i = end;
+                }
+            }
+            continue;
+        }
+
+        directive = false;
+
+        if (c == '/' && next == '/')
+        {
+            mark(i, size, Kind::Comment);
+            return continued ? State::LineComment : State::Code;
+        }
+
+        if (c == '/' && next == '*')
+        {
+            std::size_t close = line.find("*/", i + 2);
+            if (close == std::string_view::npos)
+            {
+                mark(i, size, Kind::Comment);
+                return State::BlockComment;
+            }
+
+            mark(i, close + 2, Kind::Comment);
+            i = close + 2;
+            continue;
+        }
+
+        if (c == '"' || c == '\'')
+        {
+            std::size_t close = quoted(i + 1, c);
+            if (close == std::string_view::npos)
+            {
+                mark(i, size, Kind::String);
+                return c == '"' && continued ? State::String : State::Code;
+            }
+
+            mark(i, close, Kind::String);
+            i = close;
+            continue;
+        }
+
+        if (std::isdigit(static_cast<unsigned char>(c))
+            || (c == '.' && std::isdigit(static_cast<unsigned char>(next))))
+        {
+            // Hex digits, suffixes, digit separators and signed exponents
+            std::size_t end = i + 1;
+            while (end < size
+                && (word(line[end]) || line[end] == '.' || line[end] == '\''
+                    || ((line[end] == '+' || line[end] == '-') && std::strchr("eEpP", line[end - 1]))))
+            {
+                ++end;
+            }
+
+            mark(i, end, Kind::Number);
+            i = end;
+            continue;
+        }
+
+        if (word(c))
+        {
+            std::size_t end = i + 1;
+            while (end < size && word(line[end])) ++end;
+
+            mark(i, end, classify(line.substr(i, end - i)));
+            i = end;
+            continue;
+        }
+
+        mark(i, i + 1, Kind::Text);
+        ++i;
+    }
+
+    return State::Code;
+}
+
+std::size_t
+tedit::Highlighter::nextDirty(const std::size_t from)
+const noexcept
+{
+    if (from >= m_dirty.size()) return m_states.size();
+
+    const void* found = std::memchr(m_dirty.data() + from, 1, m_dirty.size() - from);
+    return found
+        ? static_cast<const char*>(found) - m_dirty.data()
+        : m_dirty.size();
+}
+
+tedit::Highlighter::Kind
+tedit::Highlighter::classify(const std::string_view word)
+noexcept
+{
+    // Sorted, they are binary searched
+    static constexpr std::string_view keywords[] =
+    {
+        "alignas", "alignof", "asm", "break", "case", "catch", "class", "const",
+        "const_cast", "constexpr", "continue", "decltype", "default", "delete", "do",
+        "dynamic_cast", "else", "enum", "explicit", "export", "extern", "false",
+        "final", "for", "friend", "goto", "if", "inline", "mutable", "namespace",
+        "new", "noexcept", "nullptr", "operator", "override", "private", "protected",
+        "public", "register", "reinterpret_cast", "return", "sizeof", "static",
+        "static_assert", "static_cast", "struct", "switch", "template", "this",
+        "thread_local", "throw", "true", "try", "typedef", "typeid", "typename",
+        "union", "using", "virtual", "volatile", "while",
+    };
+
+    static constexpr std::string_view types[] =
+    {
+        "auto", "bool", "char", "char16_t", "char32_t", "char8_t", "double", "float",
+        "int", "int16_t", "int32_t", "int64_t", "int8_t", "long", "short", "signed",
+        "size_t", "uint16_t", "uint32_t", "uint64_t", "uint8_t", "unsigned", "void",
+        "wchar_t",
+    };
+
+    if (std::binary_search(std::begin(keywords), std::end(keywords), word)) return Kind::Keyword;
+    if (std::binary_search(std::begin(types), std::end(types), word)) return Kind::Type;
+    return Kind::Text;
+}
+#pragma endregion // tedit::Highlighter
\ No newline at end of file
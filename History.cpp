@@ -0,0 +1,288 @@
+#include "includes/History.hpp"
+
+#pragma region tedit::History
+tedit::History::History(const std::size_t limit)
+    : m_reverted{ .records = {}, .bytes = 0 },
+      m_open(false),
+      m_grouped(false),
+      m_target(Target::Undo),
+      m_bytes(0),
+      m_limit(limit)
+{
+}
+
+void
+tedit::History::insert(const std::size_t offset, const std::size_t length)
+{
+    // Undoing an insert erases the text, which is when it gets recorded
+    record(
+        {
+            .operation = Operation::Insert,
+            .offset    = offset,
+            .length    = length,
+            .text      = {},
+            .pieces    = {},
+        });
+}
+
+void
+tedit::History::erase(PieceTable& buffer, const std::size_t offset, const std::size_t length)
+{
+    Record erased =
+    {
+        .operation = Operation::Erase,
+        .offset    = offset,
+        .length    = length,
+        .text      = {},
+        .pieces    = {},
+    };
+
+    if (length <= TEDIT_HISTORY_INLINE)
+    {
+        erased.text = buffer.substr(offset, length);
+    }
+    else
+    {
+        erased.pieces = buffer.pieces(offset, length);
+    }
+
+    record(std::move(erased));
+}
+
+void
+tedit::History::seal()
+noexcept
+{
+    m_open = false;
+    m_grouped = false;
+}
+
+void
+tedit::History::group()
+noexcept
+{
+    m_open = false;
+    m_grouped = true;
+}
+
+std::optional<std::size_t>
+tedit::History::undo(PieceTable& buffer)
+{
+    if (m_undo.empty()) return std::nullopt;
+
+    Step step = std::move(m_undo.back());
+    m_undo.pop_back();
+    m_bytes -= step.bytes;
+
+    return revert(step, buffer, Target::Redo);
+}
+
+std::optional<std::size_t>
+tedit::History::redo(PieceTable& buffer)
+{
+    if (m_redo.empty()) return std::nullopt;
+
+    Step step = std::move(m_redo.back());
+    m_redo.pop_back();
+    m_bytes -= step.bytes;
+
+    return revert(step, buffer, Target::Replay);
+}
+
+bool
+tedit::History::canUndo()
+const noexcept
+{
+    return !m_undo.empty();
+}
+
+bool
+tedit::History::canRedo()
+const noexcept
+{
+    return !m_redo.empty();
+}
+
+void
+tedit::History::clear()
+noexcept
+{
+    m_undo.clear();
+    m_redo.clear();
+    m_open = false;
+    m_grouped = false;
+    m_bytes = 0;
+}
+
+std::size_t
+tedit::History::usage()
+const noexcept
+{
+    return m_bytes;
+}
+
+void
+tedit::History::record(Record next)
+{
+    if (m_target != Target::Undo)
+    {
+        m_reverted.bytes += size(next);
+        m_reverted.records.push_back(std::move(next));
+        return;
+    }
+
+    // A new edit makes what was undone unreachable
+    for (auto const& step : m_redo) m_bytes -= step.bytes;
+    m_redo.clear();
+
+    if (m_open && !m_undo.empty() && (m_grouped || touches(m_undo.back().records.back(), next)))
+    {
+        Step& step = m_undo.back();
+        Record& last = step.records.back();
+        std::size_t before = size(last);
+
+        if (touches(last, next) && extend(last, next))
+        {
+            step.bytes += size(last) - before;
+            m_bytes += size(last) - before;
+        }
+        else
+        {
+            step.bytes += size(next);
+            m_bytes += size(next);
+            step.records.push_back(std::move(next));
+        }
+    }
+    else
+    {
+        std::size_t bytes = size(next);
+
+        Step step = { .records = {}, .bytes = bytes };
+        step.records.push_back(std::move(next));
+        m_undo.push_back(std::move(step));
+        m_bytes += bytes;
+    }
+
+    m_open = true;
+    evict();
+}
+
+bool
+tedit::History::extend(Record& last, const Record& next)
+{
+    if (last.operation != next.operation) return false;
+
+    if (next.operation == Operation::Insert)
+    {
+        last.length += next.length;
+        return true;
+    }
+
+    // Only small erases are merged, a long run of them is kept in
+    // several records rather than copied over and over
+    if (!last.pieces.empty() || !next.pieces.empty()
+        || last.length + next.length > TEDIT_HISTORY_INLINE)
+    {
+        return false;
+    }
+
+    if (next.offset == last.offset)
+    {
+        last.text += next.text;
+    }
+    else
+    {
+        last.text.insert(0, next.text);
+        last.offset = next.offset;
+    }
+
+    last.length += next.length;
+    return true;
+}
+
+bool
+tedit::History::touches(const Record& last, const Record& next)
+noexcept
+{
+    // Where the cursor was left after the last edit
+    std::size_t end = last.operation == Operation::Insert
+        ? last.offset + last.length
+        : last.offset;
+
+    return next.offset == end
+        || (next.operation == Operation::Erase && next.offset + next.length == end);
+}
+
+std::size_t
+tedit::History::size(const Record& record)
+noexcept
+{
+    return sizeof(Record) + record.text.capacity() + record.pieces.capacity() * sizeof(PieceTable::Piece);
+}
+
+std::size_t
+tedit::History::revert(const Step& step, PieceTable& buffer, const Target target)
+{
+    m_target = target;
+    m_reverted = { .records = {}, .bytes = 0 };
+
+    // Latest first, so that every offset is the one it was recorded at
+    try
+    {
+        for (auto it = step.records.rbegin(); it != step.records.rend(); ++it)
+        {
+            if (it->operation == Operation::Insert)
+            {
+                buffer.erase(it->offset, it->length);
+            }
+            else if (it->pieces.empty())
+            {
+                buffer.insert(it->offset, it->text);
+            }
+            else
+            {
+                buffer.insert(it->offset, it->pieces);
+            }
+        }
+    }
+    catch (...)
+    {
+        m_target = Target::Undo;
+        throw;
+    }
+
+    m_target = Target::Undo;
+    m_bytes += m_reverted.bytes;
+
+    if (target == Target::Redo)
+    {
+        m_redo.push_back(std::move(m_reverted));
+    }
+    else
+    {
+        m_undo.push_back(std::move(m_reverted));
+    }
+
+    m_open = false;
+    evict();
+
+    return step.records.front().offset;
+}
+
+void
+tedit::History::evict()
+{
+    // The latest step is kept whatever its size, it can always be undone
+    while (m_bytes > m_limit && m_undo.size() > 1)
+    {
+        m_bytes -= m_undo.front().bytes;
+        m_undo.pop_front();
+    }
+
+    while (m_bytes > m_limit && !m_redo.empty() && m_undo.size() + m_redo.size() > 1)
+    {
+        m_bytes -= m_redo.front().bytes;
+        m_redo.erase(m_redo.begin());
+    }
+}
+#pragma endregion // tedit::History
\ No newline at end of file
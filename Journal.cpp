@@ -0,0 +1,368 @@
+#include "includes/Journal.hpp"
+#include "includes/PieceTable.hpp"
+
+#pragma region tedit::Journal
+tedit::Journal::Journal(std::string filename, const int fd)
+    : m_filename(std::move(filename)),
+      m_path(m_filename + TEDIT_JOURNAL_SUFFIX),
+      m_fd(fd),
+      m_rebases(0),
+      m_rebase_requested(false),
+      m_stopped(false),
+      m_thread(&Journal::run, this)
+{
+}
+
+tedit::Journal::~Journal()
+{
+    stop();
+
+    if (m_fd >= 0)
+    {
+        close(m_fd);
+    }
+}
+
+std::unique_ptr<tedit::Journal>
+tedit::Journal::open(const std::string& filename, PieceTable* recover)
+{
+    auto header = identify(filename);
+    if (!header) return nullptr;
+
+    std::string path = filename + TEDIT_JOURNAL_SUFFIX;
+    std::size_t valid = 0;
+
+    struct stat info;
+    bool found = stat(path.c_str(), &info) == 0;
+
+    if (recover && found)
+    {
+        std::ifstream file(path, std::ios::binary);
+        std::string content((std::istreambuf_iterator<char>(file)), std::istreambuf_iterator<char>());
+
+        // Records only make sense on top of the exact file they were made on
+        if (content.size() >= sizeof(Header)
+            && std::memcmp(content.data(), &*header, sizeof(Header)) == 0
+            && recover->length() == header->size)
+        {
+            valid = sizeof(Header) + replay(std::string_view(content).substr(sizeof(Header)), *recover);
+        }
+    }
+
+    // Records made on another version of the file are all that is left
+    // of those edits, the file may have been changed outside the editor
+    std::optional<std::string> stale;
+    if (!valid && found && static_cast<std::size_t>(info.st_size) > sizeof(Header))
+    {
+        std::string base = path + "." + std::to_string(std::time(nullptr));
+
+        // The name is claimed with O_EXCL first, so rename() only ever
+        // replaces the empty file made here and never an older journal
+        for (std::size_t attempt = 0; !stale; ++attempt)
+        {
+            std::string candidate = attempt ? base + "." + std::to_string(attempt) : base;
+            int claimed = ::open(candidate.c_str(), O_WRONLY | O_CREAT | O_EXCL | O_CLOEXEC, 0600);
+
+            if (claimed >= 0)
+            {
+                close(claimed);
+                stale = std::move(candidate);
+            }
+            else if (errno != EEXIST)
+            {
+                return nullptr;
+            }
+        }
+
+        if (std::rename(path.c_str(), stale->c_str()) != 0)
+        {
+            unlink(stale->c_str());
+            return nullptr;
+        }
+    }
+
+    int fd = ::open(path.c_str(), O_WRONLY | O_CREAT | O_CLOEXEC, 0600);
+    if (fd < 0) return nullptr;
+
+    // Either start over or drop a record torn by the crash
+    bool ready = valid
+        ? ftruncate(fd, valid) == 0
+        : ftruncate(fd, 0) == 0 && writeAll(fd, std::string_view(reinterpret_cast<const char*>(&*header), sizeof(Header)));
+
+    if (!ready || lseek(fd, 0, SEEK_END) < 0)
+    {
+        close(fd);
+        return nullptr;
+    }
+
+    auto journal = std::unique_ptr<Journal>(new Journal(filename, fd));
+    journal->m_stale = std::move(stale);
+    return journal;
+}
+
+bool
+tedit::Journal::exists(const std::string& filename)
+{
+    struct stat info;
+    return stat((filename + TEDIT_JOURNAL_SUFFIX).c_str(), &info) == 0;
+}
+
+void
+tedit::Journal::insert(const std::size_t offset, const std::string_view text)
+{
+    record(Operation::Insert, offset, text.size(), text);
+}
+
+void
+tedit::Journal::erase(const std::size_t offset, const std::size_t length)
+{
+    record(Operation::Erase, offset, length, {});
+}
+
+void
+tedit::Journal::checkpoint()
+{
+    std::lock_guard<std::mutex> lock(m_mutex);
+    m_tail.emplace();
+}
+
+void
+tedit::Journal::rebase()
+{
+    // The version of the file that was just saved
+    auto header = identify(m_filename);
+
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        if (!m_tail || !header) return;
+
+        // Everything before the checkpoint is in the saved file now, a
+        // rebase that is still pending was for an older one
+        m_rebase = Rebase { .header = *header, .records = std::move(*m_tail) };
+        m_tail.reset();
+        m_pending.clear();
+        m_rebase_requested = true;
+        ++m_rebases;
+    }
+
+    m_condition.notify_one();
+}
+
+void
+tedit::Journal::cancel()
+{
+    std::lock_guard<std::mutex> lock(m_mutex);
+    m_tail.reset();
+}
+
+const std::optional<std::string>&
+tedit::Journal::stale()
+const noexcept
+{
+    return m_stale;
+}
+
+void
+tedit::Journal::discard()
+{
+    stop();
+
+    if (m_fd >= 0)
+    {
+        close(m_fd);
+        m_fd = -1;
+    }
+
+    unlink(m_path.c_str());
+}
+
+void
+tedit::Journal::record(const Operation operation,
+                       const std::size_t offset,
+                       const std::size_t length,
+                       const std::string_view text)
+{
+    char record[1 + 2 * sizeof(std::uint64_t)];
+    std::uint64_t values[] = { offset, length };
+
+    record[0] = static_cast<char>(operation);
+    std::memcpy(record + 1, values, sizeof(values));
+
+    std::lock_guard<std::mutex> lock(m_mutex);
+    m_pending.append(record, sizeof(record)).append(text);
+
+    if (m_tail)
+    {
+        m_tail->append(record, sizeof(record)).append(text);
+    }
+}
+
+void
+tedit::Journal::run()
+{
+    bool stopped = false;
+
+    while (!stopped)
+    {
+        {
+            std::unique_lock<std::mutex> lock(m_mutex);
+            m_condition.wait_for(lock,
+                std::chrono::milliseconds(TEDIT_JOURNAL_INTERVAL),
+                [this] { return m_stopped || m_rebase_requested; });
+        }
+
+        std::string batch;
+        std::optional<Rebase> rebase;
+        std::size_t rebases;
+
+        {
+            std::lock_guard<std::mutex> lock(m_mutex);
+            batch = std::exchange(m_pending, {});
+            stopped = m_stopped;
+            rebase = m_rebase;
+            rebases = m_rebases;
+            m_rebase_requested = false;
+        }
+
+        if (!rebase)
+        {
+            if (!batch.empty() && writeAll(m_fd, batch))
+            {
+                fdatasync(m_fd);
+            }
+            continue;
+        }
+
+        // Recorded after the rebase was asked for, so on top of the saved file
+        rebase->records += batch;
+        bool restarted = restart(*rebase);
+
+        // Tried again on the next flush when it failed, nothing recorded
+        // is dropped until the new journal is on disk
+        std::lock_guard<std::mutex> lock(m_mutex);
+        if (m_rebases != rebases) continue;
+
+        if (restarted)
+        {
+            m_rebase.reset();
+        }
+        else
+        {
+            m_rebase->records += batch;
+        }
+    }
+}
+
+void
+tedit::Journal::stop()
+{
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        m_stopped = true;
+    }
+
+    m_condition.notify_one();
+
+    if (m_thread.joinable())
+    {
+        m_thread.join();
+    }
+}
+
+bool
+tedit::Journal::restart(const Rebase& rebase)
+{
+    std::string temporary = m_path + "~";
+    int fd = ::open(temporary.c_str(), O_WRONLY | O_CREAT | O_TRUNC | O_CLOEXEC, 0600);
+    if (fd < 0) return false;
+
+    if (!writeAll(fd, std::string_view(reinterpret_cast<const char*>(&rebase.header), sizeof(Header)))
+        || !writeAll(fd, rebase.records)
+        || fdatasync(fd) != 0
+        || std::rename(temporary.c_str(), m_path.c_str()) != 0)
+    {
+        close(fd);
+        unlink(temporary.c_str());
+        return false;
+    }
+
+    if (m_fd >= 0)
+    {
+        close(m_fd);
+    }
+
+    m_fd = fd;
+    return true;
+}
+
+std::optional<tedit::Journal::Header>
+tedit::Journal::identify(const std::string& filename)
+{
+    struct stat info;
+    if (stat(filename.c_str(), &info) != 0) return std::nullopt;
+
+    Header header {};
+    std::memcpy(header.magic, "TEDITSW1", sizeof(header.magic));
+    header.size = info.st_size;
+    header.seconds = info.st_mtim.tv_sec;
+    header.nanoseconds = info.st_mtim.tv_nsec;
+
+    return header;
+}
+
+std::size_t
+tedit::Journal::replay(std::string_view records, PieceTable& table)
+{
+    constexpr std::size_t fixed = 1 + 2 * sizeof(std::uint64_t);
+    std::size_t position = 0;
+
+    while (records.size() - position >= fixed)
+    {
+        std::uint64_t values[2];
+        std::memcpy(values, records.data() + position + 1, sizeof(values));
+
+        auto operation = static_cast<Operation>(records[position]);
+        std::uint64_t offset = values[0];
+        std::uint64_t length = values[1];
+
+        if (operation == Operation::Insert)
+        {
+            if (records.size() - position - fixed < length || offset > table.length()) break;
+
+            table.insert(offset, records.substr(position + fixed, length));
+            position += fixed + length;
+        }
+        else if (operation == Operation::Erase)
+        {
+            if (offset > table.length() || length > table.length() - offset) break;
+
+            table.erase(offset, length);
+            position += fixed;
+        }
+        else
+        {
+            break;
+        }
+    }
+
+    return position;
+}
+
+bool
+tedit::Journal::writeAll(const int fd, std::string_view data)
+{
+    while (!data.empty())
+    {
+        ssize_t written = write(fd, data.data(), data.size());
+        if (written < 0)
+        {
+            if (errno == EINTR) continue;
+            return false;
+        }
+
+        data.remove_prefix(written);
+    }
+
+    return true;
+}
+#pragma endregion // tedit::Journal
\ No newline at end of file
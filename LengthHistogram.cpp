@@ -0,0 +1,70 @@
+#include "includes/LengthHistogram.hpp"
+
+#pragma region tedit::LengthHistogram
+tedit::LengthHistogram::LengthHistogram()
+    : m_dense(TEDIT_HISTOGRAM_DENSE),
+      m_dense_max(0)
+{
+}
+
+void
+tedit::LengthHistogram::add(const std::size_t length)
+{
+    if (length < TEDIT_HISTOGRAM_DENSE)
+    {
+        ++m_dense[length];
+        m_dense_max = std::max(m_dense_max, length);
+    }
+    else
+    {
+        ++m_sparse[length];
+    }
+}
+
+bool
+tedit::LengthHistogram::remove(const std::size_t length)
+{
+    if (length < TEDIT_HISTOGRAM_DENSE)
+    {
+        if (!m_dense[length]) return false;
+
+        --m_dense[length];
+
+        // Bounded by the size of the array, and only when the last line
+        // of the longest length goes away
+        while (m_dense_max && !m_dense[m_dense_max])
+        {
+            --m_dense_max;
+        }
+    }
+    else
+    {
+        auto it = m_sparse.find(length);
+        if (it == m_sparse.end()) return false;
+
+        if (!--it->second)
+        {
+            m_sparse.erase(it);
+        }
+    }
+
+    return true;
+}
+
+void
+tedit::LengthHistogram::clear()
+{
+    std::fill(m_dense.begin(), m_dense.end(), 0);
+    m_sparse.clear();
+    m_dense_max = 0;
+}
+
+std::size_t
+tedit::LengthHistogram::max()
+const noexcept
+{
+    return m_sparse.empty()
+        ? m_dense_max
+        : m_sparse.rbegin()->first;
+}
+#pragma endregion // tedit::LengthHistogram
\ No newline at end of file
@@ -0,0 +1,84 @@
+#include "includes/LineIndexer.hpp"
+
+#pragma region tedit::LineIndexer
+tedit::LineIndexer::LineIndexer(std::shared_ptr<const MappedFile> file, WorkerPool& workers)
+    : m_file(std::move(file)),
+      m_indexed(0),
+      m_workers(workers),
+      m_job(workers.submit(WorkerPool::Priority::Normal, [this](const WorkerPool::Token& token) { run(token); }))
+{
+}
+
+tedit::LineIndexer::~LineIndexer()
+{
+    m_job.cancel();
+    m_workers.wait(m_job);
+}
+
+std::vector<tedit::LineIndexer::Chunk>
+tedit::LineIndexer::poll()
+{
+    std::lock_guard<std::mutex> lock(m_mutex);
+    return std::exchange(m_chunks, {});
+}
+
+std::vector<tedit::LineIndexer::Chunk>
+tedit::LineIndexer::wait()
+{
+    // Also returns when the job was cancelled or dropped before it ran
+    m_workers.wait(m_job);
+
+    std::lock_guard<std::mutex> lock(m_mutex);
+    return std::exchange(m_chunks, {});
+}
+
+float
+tedit::LineIndexer::progress()
+const noexcept
+{
+    return m_file->size()
+        ? static_cast<float>(m_indexed) / m_file->size()
+        : 1.0f;
+}
+
+void
+tedit::LineIndexer::run(const WorkerPool::Token& token)
+{
+    std::string_view content = m_file->view();
+    std::size_t position = 0;
+    std::size_t chunk_size = TEDIT_INDEX_FIRST_CHUNK;
+
+    while (position < content.size() && !token.isCancelled())
+    {
+        std::size_t end = std::min(content.size(), position + chunk_size);
+
+        // Stretch the chunk so it ends right after a line feed
+        if (end < content.size())
+        {
+            const void* found = std::memchr(content.data() + end - 1, '\n', content.size() - end + 1);
+            end = found
+                ? static_cast<const char*>(found) - content.data() + 1
+                : content.size();
+        }
+
+        LineScanner::Statistics statistics;
+        LineScanner::scan(content.substr(position, end - position), position, statistics);
+
+        Chunk chunk
+        {
+            .end        = end,
+            .line_feeds = std::move(statistics.line_feeds),
+            .non_ascii  = statistics.non_ascii,
+        };
+
+        position = end;
+        chunk_size = TEDIT_INDEX_CHUNK;
+
+        {
+            std::lock_guard<std::mutex> lock(m_mutex);
+            m_chunks.push_back(std::move(chunk));
+        }
+        m_indexed = position;
+    }
+}
+#pragma endregion // tedit::LineIndexer
\ No newline at end of file
@@ -0,0 +1,148 @@
+#include "includes/LineScanner.hpp"
+
+#pragma region tedit::LineScanner
+void
+tedit::LineScanner::scan(const std::string_view text, const std::size_t base, Statistics& statistics)
+{
+    static const Implementation implementation = detect();
+    scan(text, base, statistics, implementation);
+}
+
+void
+tedit::LineScanner::scan(const std::string_view text, const std::size_t base, Statistics& statistics,
+                         const Implementation implementation)
+{
+    // Where the open line would have started, so a line feed at `offset`
+    // ends a line of `offset - line_start` bytes
+    std::size_t line_start = base - statistics.current;
+
+    switch (implementation)
+    {
+#ifdef TEDIT_SCANNER_X86
+    case Implementation::Avx2:
+        {
+            scanAvx2(text.data(), text.size(), base, line_start, statistics);
+        }
+        break;
+    case Implementation::Sse2:
+        {
+            scanSse2(text.data(), text.size(), base, line_start, statistics);
+        }
+        break;
+#endif
+    default:
+        {
+            scanScalar(text.data(), text.size(), base, line_start, statistics);
+        }
+    }
+
+    statistics.current = base + text.size() - line_start;
+}
+
+tedit::LineScanner::Implementation
+tedit::LineScanner::detect()
+noexcept
+{
+#ifdef TEDIT_SCANNER_X86
+    __builtin_cpu_init();
+
+    if (__builtin_cpu_supports("avx2")) return Implementation::Avx2;
+    if (__builtin_cpu_supports("sse2")) return Implementation::Sse2;
+#endif
+
+    return Implementation::Scalar;
+}
+
+const char*
+tedit::LineScanner::name(const Implementation implementation)
+noexcept
+{
+    switch (implementation)
+    {
+    case Implementation::Avx2: return "avx2";
+    case Implementation::Sse2: return "sse2";
+    default:                   return "scalar";
+    }
+}
+
+void
+tedit::LineScanner::scanScalar(const char* data, const std::size_t size, const std::size_t base,
+                               std::size_t& line_start, Statistics& statistics)
+{
+    unsigned char high = 0;
+
+    for (std::size_t i = 0; i < size; ++i)
+    {
+        high |= static_cast<unsigned char>(data[i]);
+
+        if (data[i] == '\n')
+        {
+            statistics.line_feeds.push_back(base + i);
+            statistics.longest = std::max(statistics.longest, base + i - line_start);
+            line_start = base + i + 1;
+        }
+    }
+
+    statistics.non_ascii = statistics.non_ascii || (high & 0x80);
+}
+
+#ifdef TEDIT_SCANNER_X86
+__attribute__((target("sse2")))
+void
+tedit::LineScanner::scanSse2(const char* data, const std::size_t size, const std::size_t base,
+                             std::size_t& line_start, Statistics& statistics)
+{
+    const __m128i feed = _mm_set1_epi8('\n');
+    __m128i high = _mm_setzero_si128();
+    std::size_t i = 0;
+
+    for (; i + 16 <= size; i += 16)
+    {
+        __m128i block = _mm_loadu_si128(reinterpret_cast<const __m128i*>(data + i));
+        high = _mm_or_si128(high, block);
+
+        unsigned mask = _mm_movemask_epi8(_mm_cmpeq_epi8(block, feed));
+        while (mask)
+        {
+            std::size_t offset = base + i + __builtin_ctz(mask);
+            statistics.line_feeds.push_back(offset);
+            statistics.longest = std::max(statistics.longest, offset - line_start);
+            line_start = offset + 1;
+            mask &= mask - 1;
+        }
+    }
+
+    statistics.non_ascii = statistics.non_ascii || _mm_movemask_epi8(high);
+    scanScalar(data + i, size - i, base + i, line_start, statistics);
+}
+
+__attribute__((target("avx2")))
+void
+tedit::LineScanner::scanAvx2(const char* data, const std::size_t size, const std::size_t base,
+                             std::size_t& line_start, Statistics& statistics)
+{
+    const __m256i feed = _mm256_set1_epi8('\n');
+    __m256i high = _mm256_setzero_si256();
+    std::size_t i = 0;
+
+    for (; i + 32 <= size; i += 32)
+    {
+        __m256i block = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(data + i));
+        high = _mm256_or_si256(high, block);
+
+        unsigned mask = _mm256_movemask_epi8(_mm256_cmpeq_epi8(block, feed));
+        while (mask)
+        {
+            std::size_t offset = base + i + __builtin_ctz(mask);
+            statistics.line_feeds.push_back(offset);
+            statistics.longest = std::max(statistics.longest, offset - line_start);
+            line_start = offset + 1;
+            mask &= mask - 1;
+        }
+    }
+
+    statistics.non_ascii = statistics.non_ascii || _mm256_movemask_epi8(high);
+    scanScalar(data + i, size - i, base + i, line_start, statistics);
+}
+#endif
+#pragma endregion // tedit::LineScanner
\ No newline at end of file
@@ -0,0 +1,149 @@
+#include "includes/MappedFile.hpp"
+
+#pragma region tedit::MappedFile
+tedit::MappedFile::Guard tedit::MappedFile::s_guards[TEDIT_MAPPED_MAX];
+std::size_t              tedit::MappedFile::s_page = 0;
+struct sigaction         tedit::MappedFile::s_previous;
+
+tedit::MappedFile::MappedFile(const char* data, const std::size_t size)
+    : m_data(data),
+      m_size(size),
+      m_guard(size ? protect(data, size) : TEDIT_MAPPED_MAX)
+{
+}
+
+tedit::MappedFile::~MappedFile()
+{
+    // The handler stops matching the range before it goes away
+    if (m_guard < TEDIT_MAPPED_MAX)
+    {
+        s_guards[m_guard].end = nullptr;
+        s_guards[m_guard].begin = nullptr;
+    }
+
+    if (m_size)
+    {
+        munmap(const_cast<char*>(m_data), m_size);
+    }
+}
+
+std::string_view
+tedit::MappedFile::view()
+const noexcept
+{
+    return std::string_view(m_data, m_size);
+}
+
+std::size_t
+tedit::MappedFile::size()
+const noexcept
+{
+    return m_size;
+}
+
+bool
+tedit::MappedFile::isDamaged()
+const noexcept
+{
+    return m_guard < TEDIT_MAPPED_MAX && s_guards[m_guard].damaged;
+}
+
+std::shared_ptr<const tedit::MappedFile>
+tedit::MappedFile::open(const std::string& filename)
+{
+    int fd = ::open(filename.c_str(), O_RDONLY | O_CLOEXEC);
+    if (fd < 0) return nullptr;
+
+    struct stat info;
+    if (fstat(fd, &info) < 0 || !S_ISREG(info.st_mode))
+    {
+        close(fd);
+        return nullptr;
+    }
+
+    std::size_t size = info.st_size;
+    void* data = nullptr;
+
+    // mmap rejects empty mappings, an empty file is just an empty view
+    if (size)
+    {
+        data = mmap(nullptr, size, PROT_READ, MAP_PRIVATE, fd, 0);
+        if (data == MAP_FAILED)
+        {
+            close(fd);
+            return nullptr;
+        }
+    }
+
+    close(fd);
+    return std::shared_ptr<const MappedFile>(new MappedFile(static_cast<const char*>(data), size));
+}
+
+std::size_t
+tedit::MappedFile::protect(const char* data, const std::size_t size)
+{
+    static std::once_flag installed;
+    std::call_once(installed, []
+    {
+        s_page = sysconf(_SC_PAGESIZE);
+
+        struct sigaction action {};
+        action.sa_sigaction = &MappedFile::handle;
+        action.sa_flags = SA_SIGINFO;
+        sigemptyset(&action.sa_mask);
+        sigaction(SIGBUS, &action, &s_previous);
+    });
+
+    for (std::size_t i = 0; i < TEDIT_MAPPED_MAX; ++i)
+    {
+        const char* free = nullptr;
+        if (!s_guards[i].begin.compare_exchange_strong(free, data)) continue;
+
+        s_guards[i].damaged = false;
+        s_guards[i].end = data + size;
+        return i;
+    }
+
+    // Still readable, only not guarded
+    return TEDIT_MAPPED_MAX;
+}
+
+void
+tedit::MappedFile::handle(const int number, siginfo_t* info, void* context)
+{
+    const char* address = static_cast<const char*>(info->si_addr);
+
+    // Raised by the kernel for a read of one of the mappings
+    for (auto& guard : s_guards)
+    {
+        const char* begin = guard.begin;
+        const char* end = guard.end;
+        if (info->si_code <= 0 || !begin || address < begin || address >= end) continue;
+
+        // The read that faulted is retried on a page of zeros
+        std::uintptr_t page = reinterpret_cast<std::uintptr_t>(address) & ~(s_page - 1);
+        void* zeros = mmap(reinterpret_cast<void*>(page), s_page, PROT_READ,
+            MAP_PRIVATE | MAP_ANONYMOUS | MAP_FIXED, -1, 0);
+        if (zeros == MAP_FAILED) break;
+
+        guard.damaged = true;
+        return;
+    }
+
+    // Anything else goes where it would have without this handler
+    if (s_previous.sa_flags & SA_SIGINFO)
+    {
+        s_previous.sa_sigaction(number, info, context);
+    }
+    else if (s_previous.sa_handler != SIG_DFL && s_previous.sa_handler != SIG_IGN)
+    {
+        s_previous.sa_handler(number);
+    }
+    else
+    {
+        // Delivered once the handler returns, and kills the process
+        signal(number, SIG_DFL);
+        raise(number);
+    }
+}
+#pragma endregion // tedit::MappedFile
\ No newline at end of file
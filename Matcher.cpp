@@ -0,0 +1,114 @@
+#include "includes/Matcher.hpp"
+
+#pragma region tedit::Matcher
+std::size_t
+tedit::Matcher::find(const std::string_view text, const std::string_view needle)
+{
+    static const Implementation implementation = LineScanner::detect();
+    return find(text, needle, implementation);
+}
+
+std::size_t
+tedit::Matcher::find(const std::string_view text, const std::string_view needle,
+                     const Implementation implementation)
+{
+    if (needle.empty()) return 0;
+    if (needle.size() > text.size()) return std::string_view::npos;
+
+    // memchr is already vectorized
+    if (needle.size() == 1) return text.find(needle[0]);
+
+    switch (implementation)
+    {
+#ifdef TEDIT_SCANNER_X86
+    case Implementation::Avx2:
+        {
+            return findAvx2(text, needle);
+        }
+    case Implementation::Sse2:
+        {
+            return findSse2(text, needle);
+        }
+#endif
+    default:
+        {
+            return findScalar(text, needle);
+        }
+    }
+}
+
+std::size_t
+tedit::Matcher::findScalar(const std::string_view text, const std::string_view needle)
+{
+    auto found = std::search(text.begin(), text.end(),
+        std::boyer_moore_horspool_searcher(needle.begin(), needle.end()));
+
+    return found == text.end()
+        ? std::string_view::npos
+        : static_cast<std::size_t>(found - text.begin());
+}
+
+#ifdef TEDIT_SCANNER_X86
+__attribute__((target("sse2")))
+std::size_t
+tedit::Matcher::findSse2(const std::string_view text, const std::string_view needle)
+{
+    const char* data = text.data();
+    const std::size_t last = needle.size() - 1;
+    const __m128i first_byte = _mm_set1_epi8(needle.front());
+    const __m128i last_byte = _mm_set1_epi8(needle.back());
+    std::size_t i = 0;
+
+    for (; i + last + 16 <= text.size(); i += 16)
+    {
+        __m128i first_block = _mm_loadu_si128(reinterpret_cast<const __m128i*>(data + i));
+        __m128i last_block = _mm_loadu_si128(reinterpret_cast<const __m128i*>(data + i + last));
+
+        unsigned mask = _mm_movemask_epi8(_mm_and_si128(
+            _mm_cmpeq_epi8(first_block, first_byte),
+            _mm_cmpeq_epi8(last_block, last_byte)));
+
+        while (mask)
+        {
+            std::size_t position = i + __builtin_ctz(mask);
+            if (!std::memcmp(data + position + 1, needle.data() + 1, last - 1)) return position;
+            mask &= mask - 1;
+        }
+    }
+
+    std::size_t found = findScalar(text.substr(i), needle);
+    return found == std::string_view::npos ? found : i + found;
+}
+
+__attribute__((target("avx2")))
+std::size_t
+tedit::Matcher::findAvx2(const std::string_view text, const std::string_view needle)
+{
+    const char* data = text.data();
+    const std::size_t last = needle.size() - 1;
+    const __m256i first_byte = _mm256_set1_epi8(needle.front());
+    const __m256i last_byte = _mm256_set1_epi8(needle.back());
+    std::size_t i = 0;
+
+    for (; i + last + 32 <= text.size(); i += 32)
+    {
+        __m256i first_block = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(data + i));
+        __m256i last_block = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(data + i + last));
+
+        unsigned mask = _mm256_movemask_epi8(_mm256_and_si256(
+            _mm256_cmpeq_epi8(first_block, first_byte),
+            _mm256_cmpeq_epi8(last_block, last_byte)));
+
+        while (mask)
+        {
+            std::size_t position = i + __builtin_ctz(mask);
+            if (!std::memcmp(data + position + 1, needle.data() + 1, last - 1)) return position;
+            mask &= mask - 1;
+        }
+    }
+
+    std::size_t found = findScalar(text.substr(i), needle);
+    return found == std::string_view::npos ? found : i + found;
+}
+#endif
+#pragma endregion // tedit::Matcher
\ No newline at end of file
@@ -0,0 +1,1176 @@
+#include "includes/PieceTable.hpp"
+#include "includes/Journal.hpp"
+#include "includes/History.hpp"
+#include "includes/Highlighter.hpp"
+
+#pragma region tedit::PieceTable
+tedit::PieceTable::PieceTable()
+    : m_journal(nullptr),
+      m_history(nullptr),
+      m_highlighter(nullptr),
+      m_miscounted(false),
+      m_loaded(0),
+      m_loaded_offset(0),
+      m_version(0)
+{
+    m_original.content = std::make_shared<std::string>();
+    m_add.content = std::make_shared<std::string>();
+    m_lengths.add(0);
+}
+
+tedit::PieceTable::PieceTable(std::string original)
+    : PieceTable()
+{
+    m_original.content = std::make_shared<std::string>(std::move(original));
+    indexLineFeeds(m_original, 0);
+
+    if (!m_original.content->empty())
+    {
+        m_root = makeNode(makePiece(Source::Original, 0, m_original.content->size()));
+    }
+
+    m_loaded = m_loaded_offset = m_original.content->size();
+    countLines();
+}
+
+tedit::PieceTable::PieceTable(std::shared_ptr<const MappedFile> mapping, const bool indexed)
+    : PieceTable()
+{
+    m_mapping = std::move(mapping);
+
+    if (indexed && m_mapping)
+    {
+        indexLineFeeds(m_original, 0);
+
+        if (m_mapping->size())
+        {
+            m_root = makeNode(makePiece(Source::Original, 0, m_mapping->size()));
+        }
+
+        m_loaded = m_loaded_offset = m_mapping->size();
+        countLines();
+    }
+}
+
+void
+tedit::PieceTable::appendOriginal(const std::size_t end, const std::vector<std::size_t>& line_feeds,
+                                  const bool non_ascii)
+{
+    if (!m_mapping || end <= m_loaded || end > m_mapping->size())
+    {
+        throw std::out_of_range("tedit::PieceTable::appendOriginal");
+    }
+
+    m_original.line_feeds.insert(m_original.line_feeds.end(), line_feeds.begin(), line_feeds.end());
+    m_original.non_ascii = m_original.non_ascii || non_ascii;
+
+    // The active line's offsets would go stale under the new piece
+    commit();
+
+    Piece piece = makePiece(Source::Original, m_loaded, end - m_loaded);
+    std::size_t offset = m_loaded_offset;
+    std::size_t row = rowAt(offset);
+    uncountRow(row);
+
+    insertPiece(offset, piece);
+    m_loaded = end;
+    m_loaded_offset = offset + piece.length;
+
+    countInserted(row, line_feeds);
+    if (m_highlighter) m_highlighter->insert(row, line_feeds.size());
+}
+
+bool
+tedit::PieceTable::isLoading()
+const noexcept
+{
+    return m_mapping && m_loaded < m_mapping->size();
+}
+
+bool
+tedit::PieceTable::hasNonAscii()
+const noexcept
+{
+    return m_original.non_ascii || m_add.non_ascii;
+}
+
+bool
+tedit::PieceTable::isDamaged()
+const noexcept
+{
+    return m_mapping && m_mapping->isDamaged();
+}
+
+void
+tedit::PieceTable::attach(Journal* journal)
+noexcept
+{
+    m_journal = journal;
+}
+
+void
+tedit::PieceTable::attach(History* history)
+noexcept
+{
+    m_history = history;
+}
+
+void
+tedit::PieceTable::attach(Highlighter* highlighter)
+noexcept
+{
+    m_highlighter = highlighter;
+}
+
+void
+tedit::PieceTable::insert(const std::size_t offset, const std::string_view text)
+{
+    if (offset > length())
+    {
+        throw std::out_of_range("tedit::PieceTable::insert");
+    }
+
+    if (text.empty()) return;
+
+    ++m_version;
+    if (m_journal) m_journal->insert(offset, text);
+    if (m_history) m_history->insert(offset, text.size());
+
+    std::size_t row = rowAt(offset);
+    uncountRow(row);
+
+    if (text.find('\n') == std::string_view::npos && activate(offset, 0))
+    {
+        auto& active = *m_active;
+        std::size_t index = offset - active.offset;
+
+        active.edit_begin = std::min(active.edit_begin, index);
+        active.edit_tail = std::min(active.edit_tail, active.content.size() - index);
+        active.content.insert(index, text);
+    }
+    else
+    {
+        commit();
+        committedInsert(offset, text);
+    }
+
+    std::vector<std::size_t> line_feeds;
+    for (std::size_t feed = text.find('\n'); feed != std::string_view::npos; feed = text.find('\n', feed + 1))
+    {
+        line_feeds.push_back(feed);
+    }
+
+    countInserted(row, line_feeds);
+    if (m_highlighter) m_highlighter->insert(row, line_feeds.size());
+}
+
+void
+tedit::PieceTable::insert(const std::size_t offset, const std::vector<Piece>& pieces)
+{
+    if (offset > length())
+    {
+        throw std::out_of_range("tedit::PieceTable::insert");
+    }
+
+    std::size_t total = 0;
+    for (auto const& piece : pieces) total += piece.length;
+
+    if (!total) return;
+
+    ++m_version;
+    if (m_history) m_history->insert(offset, total);
+
+    std::size_t row = rowAt(offset);
+    uncountRow(row);
+
+    commit();
+
+    std::vector<std::size_t> line_feeds;
+    std::size_t position = offset;
+
+    for (auto const& piece : pieces)
+    {
+        if (m_journal) m_journal->insert(position, content(piece.source).substr(piece.start, piece.length));
+
+        auto const& feeds = buffer(piece.source).line_feeds;
+        for (auto it = std::lower_bound(feeds.begin(), feeds.end(), piece.start);
+             it != feeds.end() && *it < piece.start + piece.length; ++it)
+        {
+            line_feeds.push_back(position - offset + (*it - piece.start));
+        }
+
+        insertPiece(position, piece);
+        position += piece.length;
+    }
+
+    // As with erase, a big enough insert is cheaper to count from scratch
+    if (line_feeds.size() * TEDIT_RECOUNT_FACTOR > getLinesCount())
+    {
+        countLines();
+    }
+    else
+    {
+        countInserted(row, line_feeds);
+    }
+
+    if (m_highlighter) m_highlighter->insert(row, line_feeds.size());
+}
+
+void
+tedit::PieceTable::erase(const std::size_t offset, const std::size_t length)
+{
+    if (offset + length > this->length())
+    {
+        throw std::out_of_range("tedit::PieceTable::erase");
+    }
+
+    if (!length) return;
+
+    ++m_version;
+    if (m_journal) m_journal->erase(offset, length);
+    if (m_history) m_history->erase(*this, offset, length);
+
+    std::size_t first_row = rowAt(offset);
+    std::size_t last_row = rowAt(offset + length);
+
+    // Looking up every erased line costs O(log n) each, past a point
+    // counting the whole document again is cheaper
+    bool recount = (last_row - first_row) * TEDIT_RECOUNT_FACTOR > getLinesCount();
+    if (!recount)
+    {
+        uncountRows(first_row, last_row + 1);
+    }
+
+    if (activate(offset, length))
+    {
+        auto& active = *m_active;
+        std::size_t index = offset - active.offset;
+
+        active.edit_begin = std::min(active.edit_begin, index);
+        active.edit_tail = std::min(active.edit_tail, active.content.size() - index - length);
+        active.content.erase(index, length);
+    }
+    else
+    {
+        commit();
+        committedErase(offset, length);
+    }
+
+    if (recount || m_miscounted)
+    {
+        countLines();
+    }
+    else
+    {
+        m_lengths.add(lineLength(first_row));
+    }
+
+    if (m_highlighter) m_highlighter->erase(first_row, last_row - first_row);
+}
+
+std::size_t
+tedit::PieceTable::length()
+const noexcept
+{
+    return m_active
+        ? committedLength() + m_active->content.size() - m_active->length
+        : committedLength();
+}
+
+std::size_t
+tedit::PieceTable::getLinesCount()
+const noexcept
+{
+    return (m_root ? m_root->line_feeds : 0) + 1;
+}
+
+std::size_t
+tedit::PieceTable::lineOffset(const std::size_t row)
+const
+{
+    if (row >= getLinesCount())
+    {
+        throw std::out_of_range("tedit::PieceTable::lineOffset");
+    }
+
+    std::size_t offset = committedLineOffset(row);
+
+    if (m_active && row > m_active->row)
+    {
+        offset = offset + m_active->content.size() - m_active->length;
+    }
+
+    return offset;
+}
+
+std::size_t
+tedit::PieceTable::lineLength(const std::size_t row)
+const
+{
+    if (m_active && row == m_active->row)
+    {
+        return m_active->content.size();
+    }
+
+    std::size_t begin = lineOffset(row);
+    std::size_t end = row + 1 < getLinesCount()
+        ? lineOffset(row + 1) - 1
+        : length();
+
+    return end - begin;
+}
+
+std::size_t
+tedit::PieceTable::rowAt(const std::size_t offset)
+const
+{
+    if (offset > length())
+    {
+        throw std::out_of_range("tedit::PieceTable::rowAt");
+    }
+
+    if (m_active && offset >= m_active->offset)
+    {
+        std::size_t end = m_active->offset + m_active->content.size();
+
+        return offset <= end
+            ? m_active->row
+            : committedRowAt(offset - m_active->content.size() + m_active->length);
+    }
+
+    return committedRowAt(offset);
+}
+
+std::string
+tedit::PieceTable::line(const std::size_t row)
+const
+{
+    return substr(lineOffset(row), lineLength(row));
+}
+
+std::string
+tedit::PieceTable::substr(const std::size_t offset, const std::size_t length)
+const
+{
+    std::string result;
+    std::size_t end = std::min(offset + length, this->length());
+
+    if (offset >= end) return result;
+
+    result.reserve(end - offset);
+
+    if (!m_active)
+    {
+        append(m_root.get(), offset, end, 0, result);
+        return result;
+    }
+
+    auto const& active = *m_active;
+    std::size_t active_begin = active.offset;
+    std::size_t active_end = active.offset + active.content.size();
+
+    if (offset < active_begin)
+    {
+        append(m_root.get(), offset, std::min(end, active_begin), 0, result);
+    }
+
+    if (offset < active_end && end > active_begin)
+    {
+        std::size_t from = std::max(offset, active_begin);
+        result += active.content.substr(from - active_begin, std::min(end, active_end) - from);
+    }
+
+    if (end > active_end)
+    {
+        std::size_t from = std::max(offset, active_end);
+        append(m_root.get(),
+               from - active.content.size() + active.length,
+               end - active.content.size() + active.length,
+               0, result);
+    }
+
+    return result;
+}
+
+std::string
+tedit::PieceTable::text()
+const
+{
+    return substr(0, length());
+}
+
+std::vector<tedit::PieceTable::Piece>
+tedit::PieceTable::pieces(const std::size_t offset, const std::size_t length)
+{
+    if (offset + length > this->length())
+    {
+        throw std::out_of_range("tedit::PieceTable::pieces");
+    }
+
+    // The active line's edits are not in any piece yet
+    commit();
+
+    std::vector<Piece> result;
+    collect(m_root.get(), offset, offset + length, 0, result);
+
+    return result;
+}
+
+std::optional<std::size_t>
+tedit::PieceTable::find(const std::string_view needle, const std::size_t from)
+{
+    if (needle.empty() || from >= length()) return std::nullopt;
+
+    // The bytes at the end of the pieces already searched that could be
+    // the start of a match running into the next one
+    std::string carry;
+    std::size_t position = from;
+
+    for (auto const& piece : pieces(from, length() - from))
+    {
+        std::string_view text = content(piece.source).substr(piece.start, piece.length);
+
+        if (!carry.empty())
+        {
+            std::string window = carry;
+            window.append(text.substr(0, needle.size() - 1));
+
+            std::size_t found = window.find(needle);
+            if (found < carry.size()) return position - carry.size() + found;
+        }
+
+        std::size_t found = Matcher::find(text, needle);
+        if (found != std::string_view::npos) return position + found;
+
+        carry.append(text.substr(text.size() - std::min(text.size(), needle.size() - 1)));
+        carry.erase(0, carry.size() - std::min(carry.size(), needle.size() - 1));
+        position += piece.length;
+    }
+
+    return std::nullopt;
+}
+
+std::size_t
+tedit::PieceTable::maxLineLength()
+const
+{
+    return m_lengths.max();
+}
+
+void
+tedit::PieceTable::commit()
+{
+    if (!m_active) return;
+
+    ActiveLine active = std::move(*m_active);
+    m_active.reset();
+
+    // Nothing was edited
+    if (active.edit_begin + active.edit_tail > active.length) return;
+
+    std::size_t offset = active.offset + active.edit_begin;
+    std::size_t erased = active.length - active.edit_tail - active.edit_begin;
+    std::size_t inserted = active.content.size() - active.edit_tail - active.edit_begin;
+
+    committedErase(offset, erased);
+    committedInsert(offset, active.content.substr(active.edit_begin, inserted));
+}
+
+tedit::PieceTable::Snapshot
+tedit::PieceTable::snapshot(const bool unloaded)
+{
+    commit();
+
+    Snapshot snapshot;
+    snapshot.m_mapping = m_mapping;
+    snapshot.m_original = m_original.content;
+    snapshot.m_add = m_add.content;
+    collect(m_root.get(), snapshot.m_pieces);
+
+    // The part of the mapping not indexed yet goes where appendOriginal would put it
+    if (unloaded && isLoading())
+    {
+        std::string_view rest = m_mapping->view().substr(m_loaded);
+        std::size_t position = 0;
+        auto it = snapshot.m_pieces.begin();
+        for (; it != snapshot.m_pieces.end() && position + it->size() <= m_loaded_offset; ++it)
+        {
+            position += it->size();
+        }
+
+        if (position < m_loaded_offset)
+        {
+            std::size_t split = m_loaded_offset - position;
+            std::string_view head = it->substr(0, split);
+            *it = it->substr(split);
+            it = snapshot.m_pieces.insert(it, head) + 1;
+        }
+        snapshot.m_pieces.insert(it, rest);
+    }
+
+    std::size_t offset = 0;
+    snapshot.m_offsets.reserve(snapshot.m_pieces.size());
+    for (auto const& piece : snapshot.m_pieces)
+    {
+        snapshot.m_offsets.push_back(offset);
+        offset += piece.size();
+    }
+    snapshot.m_length = offset;
+
+    return snapshot;
+}
+
+std::size_t
+tedit::PieceTable::version()
+const noexcept
+{
+    return m_version;
+}
+
+tedit::PieceTable::Usage
+tedit::PieceTable::usage()
+const
+{
+    return
+    {
+        .text   = m_original.content->capacity() + m_add.content->capacity(),
+        .mapped = m_mapping ? m_mapping->size() : 0,
+        .index  = (m_original.line_feeds.capacity() + m_add.line_feeds.capacity()) * sizeof(std::size_t),
+        .pieces = countNodes(m_root.get()) * sizeof(Node),
+        .active = m_active ? m_active->content.capacity() : 0,
+    };
+}
+
+bool
+tedit::PieceTable::activate(const std::size_t offset, const std::size_t length)
+{
+    if (m_active)
+    {
+        if (offset >= m_active->offset
+            && offset + length <= m_active->offset + m_active->content.size())
+        {
+            return true;
+        }
+
+        commit();
+    }
+
+    std::size_t row = committedRowAt(offset);
+    std::size_t begin = committedLineOffset(row);
+    std::size_t end = row + 1 < getLinesCount()
+        ? committedLineOffset(row + 1) - 1
+        : committedLength();
+
+    if (offset + length > end) return false;
+
+    std::string content;
+    content.reserve(end - begin);
+    append(m_root.get(), begin, end, 0, content);
+
+    m_active = ActiveLine
+    {
+        .row        = row,
+        .offset     = begin,
+        .length     = end - begin,
+        .edit_begin = end - begin,
+        .edit_tail  = end - begin,
+        .content    = GapBuffer(content),
+    };
+
+    return true;
+}
+
+std::size_t
+tedit::PieceTable::committedLength()
+const noexcept
+{
+    return m_root ? m_root->length : 0;
+}
+
+std::size_t
+tedit::PieceTable::committedLineOffset(const std::size_t row)
+const
+{
+    if (row == 0) return 0;
+
+    // Find the row-th line feed, the line starts right after it
+    std::size_t remaining = row;
+    std::size_t position = 0;
+    const Node* node = m_root.get();
+
+    while (node)
+    {
+        std::size_t left_feeds = node->left ? node->left->line_feeds : 0;
+        std::size_t left_length = node->left ? node->left->length : 0;
+
+        if (remaining <= left_feeds)
+        {
+            node = node->left.get();
+            continue;
+        }
+
+        remaining -= left_feeds;
+        position += left_length;
+
+        auto const& piece = node->piece;
+        if (remaining <= piece.line_feeds)
+        {
+            auto const& feeds = buffer(piece.source).line_feeds;
+            auto first = std::lower_bound(feeds.begin(), feeds.end(), piece.start);
+            std::size_t feed = *(first + (remaining - 1));
+
+            return position + (feed - piece.start) + 1;
+        }
+
+        remaining -= piece.line_feeds;
+        position += piece.length;
+        node = node->right.get();
+    }
+
+    return committedLength();
+}
+
+std::size_t
+tedit::PieceTable::committedRowAt(const std::size_t offset)
+const
+{
+    // Count the line feeds before `offset`
+    std::size_t row = 0;
+    std::size_t remaining = offset;
+    const Node* node = m_root.get();
+
+    while (node)
+    {
+        std::size_t left_length = node->left ? node->left->length : 0;
+
+        if (remaining < left_length)
+        {
+            node = node->left.get();
+            continue;
+        }
+
+        row += node->left ? node->left->line_feeds : 0;
+        remaining -= left_length;
+
+        auto const& piece = node->piece;
+        if (remaining < piece.length)
+        {
+            return row + countLineFeeds(piece.source, piece.start, remaining);
+        }
+
+        row += piece.line_feeds;
+        remaining -= piece.length;
+        node = node->right.get();
+    }
+
+    return row;
+}
+
+void
+tedit::PieceTable::committedInsert(const std::size_t offset, const std::string_view text)
+{
+    if (text.empty()) return;
+
+    auto& add = m_add.content;
+
+    // A snapshot may still be reading the current storage, never move it
+    if (add.use_count() > 1 && add->size() + text.size() > add->capacity())
+    {
+        auto storage = std::make_shared<std::string>();
+        storage->reserve(2 * (add->size() + text.size()));
+        storage->append(*add);
+        add = std::move(storage);
+    }
+
+    std::size_t start = add->size();
+    add->append(text);
+    indexLineFeeds(m_add, start);
+
+    insertPiece(offset, makePiece(Source::Add, start, text.size()));
+}
+
+void
+tedit::PieceTable::committedErase(const std::size_t offset, const std::size_t length)
+{
+    if (!length) return;
+
+    std::unique_ptr<Node> left, middle, right;
+    split(std::move(m_root), offset, left, right);
+    split(std::move(right), length, middle, right);
+
+    m_root = merge(std::move(left), std::move(right));
+
+    if (offset < m_loaded_offset)
+    {
+        m_loaded_offset -= std::min(length, m_loaded_offset - offset);
+    }
+}
+
+void
+tedit::PieceTable::insertPiece(const std::size_t offset, const Piece& inserted)
+{
+    std::unique_ptr<Node> left, right;
+    split(std::move(m_root), offset, left, right);
+
+    // A piece that continues the one before it (typing at a stable
+    // cursor, or the next chunk of a file being loaded) extends it
+    Node* last = left.get();
+    while (last && last->right) last = last->right.get();
+
+    if (last && last->piece.source == inserted.source
+        && last->piece.start + last->piece.length == inserted.start)
+    {
+        for (Node* node = left.get(); node; node = node->right.get())
+        {
+            node->length += inserted.length;
+            node->line_feeds += inserted.line_feeds;
+        }
+
+        last->piece.length += inserted.length;
+        last->piece.line_feeds += inserted.line_feeds;
+    }
+    else
+    {
+        left = merge(std::move(left), makeNode(inserted));
+    }
+
+    m_root = merge(std::move(left), std::move(right));
+
+    // Text typed where the loaded part of the file ends stays in front of
+    // the part that is still being indexed
+    if (offset <= m_loaded_offset)
+    {
+        m_loaded_offset += inserted.length;
+    }
+}
+
+const tedit::PieceTable::Buffer&
+tedit::PieceTable::buffer(const Source source)
+const noexcept
+{
+    return source == Source::Original ? m_original : m_add;
+}
+
+std::string_view
+tedit::PieceTable::content(const Source source)
+const noexcept
+{
+    if (source == Source::Original && m_mapping)
+    {
+        return m_mapping->view();
+    }
+
+    return *buffer(source).content;
+}
+
+std::size_t
+tedit::PieceTable::countLineFeeds(const Source source, const std::size_t start, const std::size_t length)
+const
+{
+    auto const& feeds = buffer(source).line_feeds;
+    return std::lower_bound(feeds.begin(), feeds.end(), start + length)
+         - std::lower_bound(feeds.begin(), feeds.end(), start);
+}
+
+tedit::PieceTable::Piece
+tedit::PieceTable::makePiece(const Source source, const std::size_t start, const std::size_t length)
+const
+{
+    return
+    {
+        .source     = source,
+        .start      = start,
+        .length     = length,
+        .line_feeds = countLineFeeds(source, start, length),
+    };
+}
+
+std::unique_ptr<tedit::PieceTable::Node>
+tedit::PieceTable::makeNode(const Piece& piece)
+{
+    auto node = std::make_unique<Node>();
+    node->piece = piece;
+    node->priority = m_random();
+    update(*node);
+
+    return node;
+}
+
+void
+tedit::PieceTable::split(std::unique_ptr<Node> node, const std::size_t offset,
+                         std::unique_ptr<Node>& left, std::unique_ptr<Node>& right)
+{
+    if (!node)
+    {
+        left.reset();
+        right.reset();
+        return;
+    }
+
+    std::size_t left_length = node->left ? node->left->length : 0;
+    std::size_t piece_length = node->piece.length;
+
+    if (offset <= left_length)
+    {
+        split(std::move(node->left), offset, left, node->left);
+        update(*node);
+        right = std::move(node);
+    }
+    else if (offset >= left_length + piece_length)
+    {
+        split(std::move(node->right), offset - left_length - piece_length, node->right, right);
+        update(*node);
+        left = std::move(node);
+    }
+    else
+    {
+        std::size_t cut = offset - left_length;
+        auto const& piece = node->piece;
+
+        auto tail = makeNode(makePiece(piece.source, piece.start + cut, piece.length - cut));
+        node->piece = makePiece(piece.source, piece.start, cut);
+
+        right = merge(std::move(tail), std::move(node->right));
+        update(*node);
+        left = std::move(node);
+    }
+}
+
+std::unique_ptr<tedit::PieceTable::Node>
+tedit::PieceTable::merge(std::unique_ptr<Node> left, std::unique_ptr<Node> right)
+{
+    if (!left) return right;
+    if (!right) return left;
+
+    if (left->priority > right->priority)
+    {
+        left->right = merge(std::move(left->right), std::move(right));
+        update(*left);
+        return left;
+    }
+
+    right->left = merge(std::move(left), std::move(right->left));
+    update(*right);
+    return right;
+}
+
+void
+tedit::PieceTable::update(Node& node)
+noexcept
+{
+    node.length = node.piece.length;
+    node.line_feeds = node.piece.line_feeds;
+
+    for (auto const* child : { node.left.get(), node.right.get() })
+    {
+        if (child)
+        {
+            node.length += child->length;
+            node.line_feeds += child->line_feeds;
+        }
+    }
+}
+
+void
+tedit::PieceTable::append(const Node* node, const std::size_t offset, const std::size_t end,
+                          std::size_t position, std::string& result)
+const
+{
+    if (!node || position >= end || position + node->length <= offset) return;
+
+    append(node->left.get(), offset, end, position, result);
+    position += node->left ? node->left->length : 0;
+
+    auto const& piece = node->piece;
+    std::size_t piece_end = position + piece.length;
+    if (piece_end > offset && position < end)
+    {
+        std::size_t from = std::max(offset, position) - position;
+        std::size_t to = std::min(end, piece_end) - position;
+        result.append(content(piece.source).substr(piece.start + from, to - from));
+    }
+
+    append(node->right.get(), offset, end, piece_end, result);
+}
+
+std::size_t
+tedit::PieceTable::countNodes(const Node* node)
+noexcept
+{
+    return node
+        ? 1 + countNodes(node->left.get()) + countNodes(node->right.get())
+        : 0;
+}
+
+void
+tedit::PieceTable::collect(const Node* node, std::vector<std::string_view>& pieces)
+const
+{
+    if (!node) return;
+
+    collect(node->left.get(), pieces);
+    pieces.push_back(content(node->piece.source).substr(node->piece.start, node->piece.length));
+    collect(node->right.get(), pieces);
+}
+
+void
+tedit::PieceTable::collect(const Node* node, const std::size_t offset, const std::size_t end,
+                           std::size_t position, std::vector<Piece>& pieces)
+const
+{
+    if (!node || position >= end || position + node->length <= offset) return;
+
+    collect(node->left.get(), offset, end, position, pieces);
+    position += node->left ? node->left->length : 0;
+
+    auto const& piece = node->piece;
+    std::size_t piece_end = position + piece.length;
+    if (piece_end > offset && position < end)
+    {
+        std::size_t from = std::max(offset, position) - position;
+        std::size_t to = std::min(end, piece_end) - position;
+        pieces.push_back(makePiece(piece.source, piece.start + from, to - from));
+    }
+
+    collect(node->right.get(), offset, end, piece_end, pieces);
+}
+
+void
+tedit::PieceTable::countLines(const Node* node, std::size_t& current)
+{
+    if (!node) return;
+
+    countLines(node->left.get(), current);
+
+    auto const& piece = node->piece;
+    auto const& feeds = buffer(piece.source).line_feeds;
+    std::size_t position = piece.start;
+    std::size_t end = piece.start + piece.length;
+
+    for (auto it = std::lower_bound(feeds.begin(), feeds.end(), piece.start);
+         it != feeds.end() && *it < end; ++it)
+    {
+        m_lengths.add(current + (*it - position));
+        current = 0;
+        position = *it + 1;
+    }
+
+    current += end - position;
+
+    countLines(node->right.get(), current);
+}
+
+void
+tedit::PieceTable::countLines()
+{
+    // The tree has to hold the active line's latest length
+    commit();
+
+    std::size_t current = 0;
+    m_lengths.clear();
+    countLines(m_root.get(), current);
+    m_lengths.add(current);
+    m_miscounted = false;
+}
+
+void
+tedit::PieceTable::countInserted(const std::size_t row, const std::vector<std::size_t>& line_feeds)
+{
+    if (m_miscounted)
+    {
+        countLines();
+        return;
+    }
+
+    m_lengths.add(lineLength(row));
+    if (line_feeds.empty()) return;
+
+    for (std::size_t i = 1; i < line_feeds.size(); ++i)
+    {
+        m_lengths.add(line_feeds[i] - line_feeds[i - 1] - 1);
+    }
+
+    m_lengths.add(lineLength(row + line_feeds.size()));
+}
+
+void
+tedit::PieceTable::uncountRow(const std::size_t row)
+{
+    // A length that was never counted means the histogram drifted from
+    // the text, the edit under way ends with a full count instead
+    m_miscounted |= !m_lengths.remove(lineLength(row));
+}
+
+void
+tedit::PieceTable::uncountRows(const std::size_t first_row, const std::size_t last_row)
+{
+    for (std::size_t row = first_row; row < last_row; ++row)
+    {
+        uncountRow(row);
+    }
+}
+
+void
+tedit::PieceTable::indexLineFeeds(Buffer& buffer, const std::size_t from)
+{
+    std::string_view content = &buffer == &m_original && m_mapping
+        ? m_mapping->view()
+        : std::string_view(*buffer.content);
+
+    LineScanner::Statistics statistics;
+    statistics.line_feeds = std::move(buffer.line_feeds);
+    LineScanner::scan(content.substr(from), from, statistics);
+
+    buffer.line_feeds = std::move(statistics.line_feeds);
+    buffer.non_ascii = buffer.non_ascii || statistics.non_ascii;
+}
+#pragma endregion // tedit::PieceTable
+
+#pragma region tedit::PieceTable::Snapshot
+std::size_t
+tedit::PieceTable::Snapshot::length()
+const noexcept
+{
+    return m_length;
+}
+
+std::string
+tedit::PieceTable::Snapshot::substr(const std::size_t offset, const std::size_t length)
+const
+{
+    std::string result;
+    result.reserve(length);
+
+    for (std::size_t i = pieceAt(offset); i < m_pieces.size() && result.size() < length; ++i)
+    {
+        std::size_t from = offset + result.size() - m_offsets[i];
+        result.append(m_pieces[i].substr(from, length - result.size()));
+    }
+
+    return result;
+}
+
+std::string_view
+tedit::PieceTable::Snapshot::view(const std::size_t offset, const std::size_t length, std::string& scratch)
+const
+{
+    std::size_t i = pieceAt(offset);
+
+    if (i < m_pieces.size() && offset - m_offsets[i] + length <= m_pieces[i].size())
+    {
+        return m_pieces[i].substr(offset - m_offsets[i], length);
+    }
+
+    scratch = substr(offset, length);
+    return scratch;
+}
+
+std::size_t
+tedit::PieceTable::Snapshot::find(const char c, const std::size_t from)
+const noexcept
+{
+    for (std::size_t i = pieceAt(from); i < m_pieces.size(); ++i)
+    {
+        std::size_t start = from > m_offsets[i] ? from - m_offsets[i] : 0;
+        std::size_t found = m_pieces[i].find(c, start);
+
+        if (found != std::string_view::npos) return m_offsets[i] + found;
+    }
+
+    return length();
+}
+
+std::size_t
+tedit::PieceTable::Snapshot::pieceAt(const std::size_t offset)
+const noexcept
+{
+    // The last piece starting at or before `offset`
+    auto found = std::upper_bound(m_offsets.begin(), m_offsets.end(), offset);
+    return found == m_offsets.begin() ? 0 : found - m_offsets.begin() - 1;
+}
+
+bool
+tedit::PieceTable::Snapshot::write(const std::string& filename)
+const
+{
+    std::string temporary = filename + ".tedit~";
+
+    // Keep the permissions of the file being replaced
+    struct stat info;
+    mode_t mode = stat(filename.c_str(), &info) == 0 ? (info.st_mode & 07777) : 0666;
+
+    int fd = ::open(temporary.c_str(), O_WRONLY | O_CREAT | O_TRUNC | O_CLOEXEC, mode);
+    if (fd < 0) return false;
+
+    std::vector<iovec> batch;
+    batch.reserve(TEDIT_WRITEV_BATCH);
+    bool written = true;
+
+    for (std::size_t i = 0; i < m_pieces.size() && written;)
+    {
+        batch.clear();
+        for (; i < m_pieces.size() && batch.size() < TEDIT_WRITEV_BATCH; ++i)
+        {
+            batch.push_back({ const_cast<char*>(m_pieces[i].data()), m_pieces[i].size() });
+        }
+
+        written = writeAll(fd, batch);
+    }
+
+    written = written && fsync(fd) == 0;
+    written = close(fd) == 0 && written;
+
+    // Either the old or the new content is on disk, never half of it
+    if (!written || std::rename(temporary.c_str(), filename.c_str()) != 0)
+    {
+        unlink(temporary.c_str());
+        return false;
+    }
+
+    std::size_t slash = filename.find_last_of('/');
+    std::string directory = slash == std::string::npos ? "." : filename.substr(0, slash + 1);
+
+    int directory_fd = ::open(directory.c_str(), O_RDONLY | O_DIRECTORY | O_CLOEXEC);
+    if (directory_fd >= 0)
+    {
+        fsync(directory_fd);
+        close(directory_fd);
+    }
+
+    return true;
+}
+
+bool
+tedit::PieceTable::Snapshot::writeAll(const int fd, std::vector<iovec>& batch)
+{
+    iovec* vector = batch.data();
+    std::size_t count = batch.size();
+
+    while (count)
+    {
+        ssize_t result = writev(fd, vector, count);
+        if (result < 0)
+        {
+            if (errno == EINTR) continue;
+            return false;
+        }
+
+        // Skip what was written, short writes resume mid-buffer
+        std::size_t written = result;
+        while (count && written >= vector->iov_len)
+        {
+            written -= vector->iov_len;
+            ++vector;
+            --count;
+        }
+
+        if (count)
+        {
+            vector->iov_base = static_cast<char*>(vector->iov_base) + written;
+            vector->iov_len -= written;
+        }
+    }
+
+    return true;
+}
+#pragma endregion // tedit::PieceTable::Snapshot
\ No newline at end of file
@@ -0,0 +1,162 @@
+#include "includes/Replacer.hpp"
+
+#pragma region tedit::Replacer
+tedit::Replacer::Replacer(WorkerPool& workers, PieceTable::Snapshot snapshot, std::regex regex, std::string format)
+    : m_snapshot(std::make_shared<const PieceTable::Snapshot>(std::move(snapshot))),
+      m_regex(std::make_shared<const std::regex>(std::move(regex))),
+      m_format(std::move(format)),
+      m_found(0),
+      m_skipped(0),
+      m_workers(workers)
+{
+    std::size_t length = m_snapshot->length();
+    std::size_t count = std::max<std::size_t>(1, std::min(length, workers.size() * TEDIT_REPLACE_CHUNKS_PER_THREAD));
+
+    // Every chunk starts at a line start, so each line is scanned by
+    // exactly one of them
+    std::vector<std::pair<std::size_t, std::size_t>> ranges;
+    std::size_t begin = 0;
+    for (std::size_t i = 1; i <= count; ++i)
+    {
+        std::size_t end = i == count ? length : lineStart(length / count * i);
+        if (end <= begin && i != count) continue;
+
+        ranges.emplace_back(begin, end);
+        begin = end;
+    }
+
+    // Every chunk writes its own slot, nothing is moved once they start
+    m_results.resize(ranges.size());
+
+    for (std::size_t i = 0; i < ranges.size(); ++i)
+    {
+        auto [begin, end] = ranges[i];
+        m_chunks.push_back(workers.submit(WorkerPool::Priority::Low,
+            [this, i, begin = begin, end = end](const WorkerPool::Token& token)
+            {
+                m_results[i] = scan(begin, end, token);
+            }));
+    }
+}
+
+tedit::Replacer::~Replacer()
+{
+    for (auto& chunk : m_chunks)
+    {
+        chunk.cancel();
+    }
+
+    for (auto const& chunk : m_chunks)
+    {
+        m_workers.wait(chunk);
+    }
+}
+
+bool
+tedit::Replacer::isDone()
+const
+{
+    return std::all_of(m_chunks.begin(), m_chunks.end(), [](auto const& chunk)
+    {
+        return chunk.isDone();
+    });
+}
+
+std::size_t
+tedit::Replacer::found()
+const noexcept
+{
+    return m_found.load(std::memory_order_relaxed);
+}
+
+std::size_t
+tedit::Replacer::skipped()
+const noexcept
+{
+    return m_skipped.load(std::memory_order_relaxed);
+}
+
+const std::regex&
+tedit::Replacer::regex()
+const noexcept
+{
+    return *m_regex;
+}
+
+const std::string&
+tedit::Replacer::format()
+const noexcept
+{
+    return m_format;
+}
+
+std::vector<tedit::Replacer::Match>
+tedit::Replacer::take()
+{
+    std::vector<Match> matches;
+    matches.reserve(found());
+
+    for (std::size_t i = 0; i < m_chunks.size(); ++i)
+    {
+        m_workers.wait(m_chunks[i]);
+
+        auto part = std::exchange(m_results[i], {});
+        std::move(part.begin(), part.end(), std::back_inserter(matches));
+    }
+
+    m_chunks.clear();
+    m_results.clear();
+    return matches;
+}
+
+std::vector<tedit::Replacer::Match>
+tedit::Replacer::scan(const std::size_t begin, const std::size_t end, const WorkerPool::Token& token)
+{
+    std::vector<Match> matches;
+    std::string scratch; // Lines that span pieces
+
+    for (std::size_t start = begin; start < end && !token.isCancelled(); )
+    {
+        std::size_t stop = std::min(m_snapshot->find('\n', start), end);
+
+        // The recursion of std::regex would run out of stack on a long
+        // minified or log line and take the editor down with it
+        if (stop - start > TEDIT_REPLACE_MAX_LINE)
+        {
+            m_skipped.fetch_add(1, std::memory_order_relaxed);
+            start = stop + 1;
+            continue;
+        }
+
+        std::string_view line = m_snapshot->view(start, stop - start, scratch);
+        std::size_t before = matches.size();
+
+        for (std::cregex_iterator it(line.data(), line.data() + line.size(), *m_regex), done; it != done; ++it)
+        {
+            auto const& match = *it;
+
+            matches.push_back(
+                {
+                    .offset      = start + static_cast<std::size_t>(match[0].first - line.data()),
+                    .length      = static_cast<std::size_t>(match.length()),
+                    .replacement = match.format(m_format),
+                });
+        }
+
+        m_found.fetch_add(matches.size() - before, std::memory_order_relaxed);
+        start = stop + 1;
+    }
+
+    return matches;
+}
+
+std::size_t
+tedit::Replacer::lineStart(const std::size_t offset)
+const noexcept
+{
+    if (!offset) return 0;
+
+    std::size_t feed = m_snapshot->find('\n', offset - 1);
+    return std::min(feed + 1, m_snapshot->length());
+}
+#pragma endregion // tedit::Replacer
\ No newline at end of file
@@ -2,7 +2,11 @@
 
 tedit::Scroller::Scroller::Scroller(const Direction& direction, const size_t& max_size)
     : m_direction(direction),
-      m_max_size(max_size)
+      m_max_size(max_size),
+      m_pointer(0),
+      m_anchor(0),
+      m_step(0),
+      m_fraction(0)
 {
     setFillColor(sf::Color(241, 241, 241));
 }
@@ -14,46 +18,49 @@ tedit::Scroller::startScrolling(const sf::Event::MouseButtonEvent& event)
         && m_shape.getGlobalBounds().contains(sf::Vector2f(event.x, event.y)))
     {
         m_hold = m_direction == Direction::Vertical ? event.y : event.x;
-        auto position = m_shape.getPosition();
-        m_release = m_direction == Direction::Vertical ? position.y : position.x;
+        m_pointer = *m_hold;
+        m_anchor = m_fraction;
+        m_step = 0;
     }
 }
 
 void
-tedit::Scroller::endScrolling(const sf::Event::MouseButtonEvent& event)
+tedit::Scroller::endScrolling(const sf::Event::MouseButtonEvent&)
 {
-    m_release = m_direction == Direction::Vertical ? event.y : event.x;
     m_hold = std::nullopt;
 }
 
-std::optional<std::size_t>
-tedit::Scroller::mouseScroll(const int mouseX, const int mouseY)
+std::optional<double>
+tedit::Scroller::mouseScroll(const int mouseX, const int mouseY, const double step)
 {
     if (!m_hold) return std::nullopt;
+    if (travel() <= 0) return 0.0;
 
-    if (m_direction == Direction::Vertical)
-    {
-        int diff = mouseY - m_hold.value();
-        setPosition(m_shape.getPosition().x, m_release + diff);
-    }
-    else
+    int pointer = m_direction == Direction::Vertical ? mouseY : mouseX;
+    double per_pixel = step > 0 ? std::min(step, 1.0 / travel()) : 1.0 / travel();
+
+    // Switching between coarse and fine, or the thumb being resized as
+    // the file loads, carries on from where the drag got to
+    if (per_pixel != m_step)
     {
-        int diff = mouseX - m_hold.value();
-        setPosition(m_release + diff, m_shape.getPosition().y);
+        m_hold = m_pointer;
+        m_anchor = m_fraction;
+        m_step = per_pixel;
     }
 
-    std::size_t total = m_max_size - getSize();
-    std::size_t scrolled = total - (total - getPosition());
+    m_pointer = pointer;
 
-    return scrolled * 100 / total;
+    // In doubles, a float thumb position cannot tell rows apart past
+    // a few million of them
+    scrollTo(m_anchor + (pointer - *m_hold) * per_pixel);
+    return m_fraction;
 }
 
 void
-tedit::Scroller::scrollTo(const int prec)
+tedit::Scroller::scrollTo(const double fraction)
 {
-    std::size_t total = m_max_size - getSize();
-
-    int value = total * prec / 100;
+    m_fraction = std::clamp(fraction, 0.0, 1.0);
+    float value = m_fraction * travel();
 
     if (m_direction == Direction::Vertical)
     {
@@ -65,6 +72,13 @@ tedit::Scroller::scrollTo(const int prec)
     }
 }
 
+const sf::RectangleShape&
+tedit::Scroller::getShape()
+const noexcept
+{
+    return m_shape;
+}
+
 void
 tedit::Scroller::draw(sf::RenderTarget& target, sf::RenderStates states)
 const
@@ -128,4 +142,11 @@ void
 tedit::Scroller::setFillColor(const sf::Color& color)
 {
     m_shape.setFillColor(color);
+}
+
+float
+tedit::Scroller::travel()
+const noexcept
+{
+    return static_cast<float>(m_max_size) - getSize();
 }
\ No newline at end of file
@@ -0,0 +1,98 @@
+#include "includes/TextRenderer.hpp"
+
+#pragma region tedit::TextRenderer
+tedit::TextRenderer::TextRenderer(const sf::Font& font, const unsigned int size, const float advance, const bool bold)
+    : m_font(&font),
+      m_size(size),
+      m_advance(advance),
+      m_bold(bold),
+      m_vertices(sf::Triangles)
+{
+    // Load the printable ASCII range up front so the page rarely grows mid-frame
+    for (sf::Uint32 c = ' '; c <= '~'; ++c)
+    {
+        m_font->getGlyph(c, m_size, m_bold);
+    }
+}
+
+void
+tedit::TextRenderer::clear()
+{
+    m_vertices.clear();
+}
+
+void
+tedit::TextRenderer::addText(const sf::String& text, const float x, const float y, const sf::Color& color)
+{
+    for (std::size_t i = 0; i < text.getSize(); ++i)
+    {
+        addGlyph(text[i], x + i * m_advance, y + m_size, color);
+    }
+}
+
+void
+tedit::TextRenderer::addText(const sf::String& text, const float x, const float y,
+                             const std::vector<sf::Color>& colors)
+{
+    for (std::size_t i = 0; i < text.getSize(); ++i)
+    {
+        addGlyph(text[i], x + i * m_advance, y + m_size, i < colors.size() ? colors[i] : sf::Color::White);
+    }
+}
+
+void
+tedit::TextRenderer::addRectangle(const sf::FloatRect& rectangle, const sf::Color& color)
+{
+    // Every glyph page keeps a white square at its top left corner
+    addQuad(rectangle, sf::FloatRect(1, 1, 0, 0), color);
+}
+
+void
+tedit::TextRenderer::draw(sf::RenderTarget& target, sf::RenderStates states)
+const
+{
+    if (!m_vertices.getVertexCount()) return;
+
+    // Looked up on every draw, the page is recreated when it grows
+    states.texture = &m_font->getTexture(m_size);
+    target.draw(m_vertices, states);
+}
+
+void
+tedit::TextRenderer::addGlyph(const sf::Uint32 c, const float left, const float baseline, const sf::Color& color)
+{
+    if (c == ' ' || c == '\t' || c == '\n' || c == '\r') return;
+
+    // Same padding sf::Text uses so antialiased edges are not clipped
+    constexpr float padding = 1.0f;
+    const sf::Glyph& glyph = m_font->getGlyph(c, m_size, m_bold);
+
+    addQuad(
+        sf::FloatRect(left + glyph.bounds.left - padding, baseline + glyph.bounds.top - padding,
+            glyph.bounds.width + 2 * padding, glyph.bounds.height + 2 * padding),
+        sf::FloatRect(glyph.textureRect.left - padding, glyph.textureRect.top - padding,
+            glyph.textureRect.width + 2 * padding, glyph.textureRect.height + 2 * padding),
+        color);
+}
+
+void
+tedit::TextRenderer::addQuad(const sf::FloatRect& position, const sf::FloatRect& texture, const sf::Color& color)
+{
+    float right = position.left + position.width;
+    float bottom = position.top + position.height;
+    float u = texture.left + texture.width;
+    float v = texture.top + texture.height;
+
+    sf::Vertex top_left(sf::Vector2f(position.left, position.top), color, sf::Vector2f(texture.left, texture.top));
+    sf::Vertex top_right(sf::Vector2f(right, position.top), color, sf::Vector2f(u, texture.top));
+    sf::Vertex bottom_left(sf::Vector2f(position.left, bottom), color, sf::Vector2f(texture.left, v));
+    sf::Vertex bottom_right(sf::Vector2f(right, bottom), color, sf::Vector2f(u, v));
+
+    m_vertices.append(top_left);
+    m_vertices.append(top_right);
+    m_vertices.append(bottom_left);
+    m_vertices.append(bottom_left);
+    m_vertices.append(top_right);
+    m_vertices.append(bottom_right);
+}
+#pragma endregion // tedit::TextRenderer
\ No newline at end of file
@@ -0,0 +1,250 @@
+#include "includes/WorkerPool.hpp"
+
+#pragma region tedit::WorkerPool::Token
+tedit::WorkerPool::Token::Token()
+    : m_state(std::make_shared<State>())
+{
+    m_state->cancelled = false;
+    m_state->done = false;
+}
+
+void
+tedit::WorkerPool::Token::cancel()
+noexcept
+{
+    m_state->cancelled = true;
+}
+
+bool
+tedit::WorkerPool::Token::isCancelled()
+const noexcept
+{
+    return m_state->cancelled;
+}
+
+bool
+tedit::WorkerPool::Token::isDone()
+const noexcept
+{
+    return m_state->done;
+}
+#pragma endregion // tedit::WorkerPool::Token
+
+#pragma region tedit::WorkerPool
+thread_local std::size_t tedit::WorkerPool::s_worker = std::numeric_limits<std::size_t>::max();
+
+tedit::WorkerPool::WorkerPool(const std::size_t threads)
+    : m_next(0),
+      m_pending(0),
+      m_running(0),
+      m_stopped(false)
+{
+    std::size_t count = std::max<std::size_t>(1, threads);
+
+    for (std::size_t i = 0; i < count; ++i)
+    {
+        m_queues.push_back(std::make_unique<Queue>());
+    }
+
+    for (std::size_t i = 0; i < count; ++i)
+    {
+        m_threads.emplace_back(&WorkerPool::run, this, i);
+    }
+}
+
+tedit::WorkerPool::~WorkerPool()
+{
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        m_stopped = true;
+    }
+    m_work.notify_all();
+
+    for (auto& thread : m_threads)
+    {
+        thread.join();
+    }
+
+    // Dropped without running, but done all the same for whoever waits
+    for (auto& queue : m_queues)
+    {
+        for (auto& tasks : queue->tasks)
+        {
+            for (auto& task : tasks)
+            {
+                finish(task.token);
+            }
+        }
+    }
+}
+
+void
+tedit::WorkerPool::dispatch()
+{
+    std::vector<Completion> completed;
+    {
+        std::lock_guard<std::mutex> lock(m_completed_mutex);
+        completed.swap(m_completed);
+    }
+
+    for (auto& completion : completed)
+    {
+        if (!completion.token.isCancelled())
+        {
+            completion.run();
+        }
+    }
+}
+
+void
+tedit::WorkerPool::wait(const Token& token)
+{
+    std::unique_lock<std::mutex> lock(m_mutex);
+    m_finished.wait(lock, [&token] { return token.isDone(); });
+}
+
+bool
+tedit::WorkerPool::isBusy()
+{
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        if (m_pending || m_running) return true;
+    }
+
+    std::lock_guard<std::mutex> lock(m_completed_mutex);
+    return !m_completed.empty();
+}
+
+std::size_t
+tedit::WorkerPool::size()
+const noexcept
+{
+    return m_threads.size();
+}
+
+tedit::WorkerPool::Token
+tedit::WorkerPool::push(const Priority priority, std::function<void(const Token&)> work)
+{
+    Token token;
+
+    // Jobs queued by a job stay on its worker, the others are spread out
+    std::size_t index = s_worker < m_queues.size()
+        ? s_worker
+        : m_next.fetch_add(1, std::memory_order_relaxed) % m_queues.size();
+
+    {
+        std::lock_guard<std::mutex> lock(m_queues[index]->mutex);
+        m_queues[index]->tasks[static_cast<std::size_t>(priority)].push_back(
+            {
+                .run   = std::move(work),
+                .token = token,
+            });
+    }
+
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        ++m_pending;
+    }
+    m_work.notify_one();
+
+    return token;
+}
+
+void
+tedit::WorkerPool::complete(const Token& token, std::function<void()> done)
+{
+    if (token.isCancelled()) return;
+
+    std::lock_guard<std::mutex> lock(m_completed_mutex);
+    m_completed.push_back(
+        {
+            .run   = std::move(done),
+            .token = token,
+        });
+}
+
+void
+tedit::WorkerPool::run(const std::size_t index)
+{
+    s_worker = index;
+
+    while (true)
+    {
+        {
+            std::unique_lock<std::mutex> lock(m_mutex);
+            m_work.wait(lock, [this] { return m_stopped || m_pending; });
+
+            if (m_stopped) return;
+
+            // Every claim is backed by a job in one of the queues
+            --m_pending;
+            ++m_running;
+        }
+
+        Task task;
+        while (!take(index, task))
+        {
+            std::this_thread::yield();
+        }
+
+        if (!task.token.isCancelled())
+        {
+            task.run(task.token);
+        }
+
+        {
+            std::lock_guard<std::mutex> lock(m_mutex);
+            --m_running;
+        }
+        finish(task.token);
+    }
+}
+
+bool
+tedit::WorkerPool::take(const std::size_t index, Task& task)
+{
+    // A job of higher priority goes first, even from another queue
+    for (std::size_t priority = 0; priority < 3; ++priority)
+    {
+        {
+            auto& own = *m_queues[index];
+            std::lock_guard<std::mutex> lock(own.mutex);
+            auto& tasks = own.tasks[priority];
+
+            if (!tasks.empty())
+            {
+                task = std::move(tasks.back());
+                tasks.pop_back();
+                return true;
+            }
+        }
+
+        for (std::size_t i = 1; i < m_queues.size(); ++i)
+        {
+            auto& other = *m_queues[(index + i) % m_queues.size()];
+            std::lock_guard<std::mutex> lock(other.mutex);
+            auto& tasks = other.tasks[priority];
+
+            if (!tasks.empty())
+            {
+                task = std::move(tasks.front());
+                tasks.pop_front();
+                return true;
+            }
+        }
+    }
+
+    return false;
+}
+
+void
+tedit::WorkerPool::finish(const Token& token)
+{
+    // Under the lock so wait() cannot miss it
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        token.m_state->done = true;
+    }
+    m_finished.notify_all();
+}
+#pragma endregion // tedit::WorkerPool
\ No newline at end of file
@@ -0,0 +1,68 @@
+#include <chrono>
+#include <iostream>
+#include <random>
+#include <sstream>
+#include <string>
+
+#include "../includes/LineScanner.hpp"
+
+#define TEDIT_BENCH_SIZE (100 * 1024 * 1024)
+
+template <typename F>
+static double
+measure(F&& f)
+{
+    auto start = std::chrono::steady_clock::now();
+    f();
+    return std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+}
+
+int main()
+{
+    // Log-like input: lines between 0 and 200 bytes
+    std::string input;
+    input.reserve(TEDIT_BENCH_SIZE);
+    std::minstd_rand random(42);
+    while (input.size() < TEDIT_BENCH_SIZE)
+    {
+        input.append(random() % 200, 'a' + random() % 26);
+        input += '\n';
+    }
+
+    // What Editor::open used to do
+    {
+        std::size_t lines = 0, longest = 0;
+        double ms = measure([&]
+        {
+            std::istringstream stream(input);
+            for (std::string line; std::getline(stream, line); ++lines)
+            {
+                longest = std::max(longest, line.size());
+            }
+        });
+
+        std::cout << "getline: " << ms << " ms, " << lines << " lines, longest " << longest << '\n';
+    }
+
+    using Implementation = tedit::LineScanner::Implementation;
+    auto available = tedit::LineScanner::detect();
+
+    for (auto implementation : { Implementation::Scalar, Implementation::Sse2, Implementation::Avx2 })
+    {
+        if (implementation > available) break;
+
+        tedit::LineScanner::Statistics statistics;
+        statistics.line_feeds.reserve(input.size() / 64);
+
+        double ms = measure([&]
+        {
+            tedit::LineScanner::scan(input, 0, statistics, implementation);
+        });
+
+        std::cout << tedit::LineScanner::name(implementation) << ": " << ms << " ms, "
+                  << statistics.line_feeds.size() << " lines, longest " << statistics.longest
+                  << " (" << (input.size() / 1e6) / (ms / 1e3) << " MB/s)\n";
+    }
+
+    return 0;
+}
\ No newline at end of file
@@ -0,0 +1,90 @@
+#include <iostream>
+#include <memory>
+#include <random>
+#include <string>
+
+#include <SFML/Graphics/RectangleShape.hpp>
+#include <SFML/Graphics/Text.hpp>
+#include <SFML/Graphics/Vertex.hpp>
+
+#include "../includes/PieceTable.hpp"
+
+#define TEDIT_BENCH_LINES 5000000
+
+// The layout of a line before the piece table, each one was a
+// std::shared_ptr<Line> holding its own sf::Text
+struct OldLine
+{
+    sf::RectangleShape shape;
+    std::size_t        index;
+    std::string        content;
+    sf::Text           text;
+    sf::RectangleShape selected;
+};
+
+// Usage: memory.out [file], without a file a 5M line log is generated
+int main(int argc, char** argv)
+{
+    tedit::PieceTable table;
+
+    if (argc > 1)
+    {
+        auto mapping = tedit::MappedFile::open(argv[1]);
+        if (!mapping)
+        {
+            std::cerr << "cannot open " << argv[1] << '\n';
+            return 1;
+        }
+
+        table = tedit::PieceTable(std::move(mapping));
+    }
+    else
+    {
+        std::string input;
+        std::minstd_rand random(42);
+        for (std::size_t i = 0; i < TEDIT_BENCH_LINES; ++i)
+        {
+            input.append(random() % 120, 'a' + random() % 26);
+            input += '\n';
+        }
+
+        table = tedit::PieceTable(std::move(input));
+    }
+
+    // A few edits spread over the file, as after a short editing session
+    for (std::size_t i = 1; i <= 100; ++i)
+    {
+        table.insert(table.lineOffset(table.getLinesCount() * i / 101), "edited\n");
+    }
+
+    auto usage = table.usage();
+    std::size_t lines = table.getLinesCount();
+    std::size_t overhead = usage.index + usage.pieces + usage.active;
+
+    std::cout << lines << " lines, " << table.length() << " bytes of text\n"
+              << "text:     " << usage.text << " bytes in memory, " << usage.mapped << " mapped\n"
+              << "index:    " << usage.index << " bytes\n"
+              << "pieces:   " << usage.pieces << " bytes\n"
+              << "active:   " << usage.active << " bytes\n"
+              << "per line: " << static_cast<double>(overhead) / lines << " bytes besides the text\n";
+
+    // Worked out from the same lines rather than built, the text copied
+    // into every sf::Text is UTF-32, and the glyphs get two triangles
+    // each once the line is drawn
+    std::size_t fixed = sizeof(std::shared_ptr<OldLine>) + sizeof(OldLine) + 3 * sizeof(void*);
+    std::size_t old_overhead = 0;
+    std::size_t old_drawn = 0;
+
+    for (std::size_t row = 0; row < lines; ++row)
+    {
+        std::size_t length = table.lineLength(row);
+        old_overhead += fixed + (length + 1) * sizeof(sf::Uint32);
+        old_drawn += length * 6 * sizeof(sf::Vertex);
+    }
+
+    std::cout << "old model, one std::shared_ptr<Line> with an sf::Text per line:\n"
+              << "per line: " << static_cast<double>(old_overhead) / lines << " bytes besides the text, "
+              << static_cast<double>(old_drawn) / lines << " more once drawn\n";
+
+    return 0;
+}
\ No newline at end of file
@@ -4,11 +4,22 @@
 #include <iostream>
 #include <fstream>
 #include <string>
+#include <string_view>
+#include <iterator>
 #include <vector>
 #include <memory>
 #include <optional>
 #include <numeric>
 #include <cstring>
+#include <limits>
+#include <cmath>
+#include <cerrno>
+
+#include <fcntl.h>
+#include <poll.h>
+#include <signal.h>
+#include <sys/wait.h>
+#include <unistd.h>
 
 #include <SFML/Graphics/Drawable.hpp>
 #include <SFML/Graphics/RectangleShape.hpp>
@@ -18,16 +29,28 @@
 #include <SFML/Graphics/Transform.hpp>
 #include <SFML/Window/Event.hpp>
 #include <SFML/Window/Mouse.hpp>
+#include <SFML/Window/Keyboard.hpp>
 
 #include "Scroller.hpp"
+#include "PieceTable.hpp"
+#include "LineIndexer.hpp"
+#include "Journal.hpp"
+#include "History.hpp"
+#include "Replacer.hpp"
+#include "WorkerPool.hpp"
+#include "Highlighter.hpp"
+#include "EditorView.hpp"
 
 #define TEDIT_SCROLL_SIZE 7
+#define TEDIT_OVERSCAN    2   // Rows drawn past each edge of the viewport
+#define TEDIT_WHEEL_LINES 3   // Rows scrolled per notch of the mouse wheel
+#define TEDIT_DIALOG_POLL 100 // Milliseconds an open dialog waits between checks for being cancelled
 
 namespace tedit
 {
     class Editor;
 
-    class Editor : public sf::Drawable
+    class Editor
     {
     public:
         struct Font
@@ -48,6 +71,29 @@ namespace tedit
             minmax(const Position&, const Position&);
         };
 
+        // Only the two ends are stored, the rows in between are worked
+        // out when they are drawn, so moving the head costs the same
+        // however long the selection is
+        struct Selection
+        {
+            Position anchor; // Where the selection started, stays put
+            Position head;   // Follows the cursor
+
+            bool
+            empty()
+            const noexcept;
+
+            std::pair<Position, Position>
+            range()
+            const noexcept;
+
+            // Columns selected on `row`, empty when it is outside
+            std::pair<std::size_t, std::size_t>
+            columns(const std::size_t row,
+                    const std::size_t length)
+            const noexcept;
+        };
+
         struct Size
         {
             std::size_t width;
@@ -72,19 +118,15 @@ namespace tedit
             Left,
         };
 
-        class Line : public sf::Drawable
+        class Line
         {
         private:
-            sf::RectangleShape m_shape; // ! Not Used Yet
-            std::size_t        m_index;
-
-            std::string m_content;
-            sf::Text    m_sf_text;
-
-            sf::RectangleShape m_selected;
+            PieceTable* m_buffer;
+            std::size_t m_index;
 
         public:
-            Line(const std::string& content);
+            Line(PieceTable&,
+                 const std::size_t index);
 
             void
             insertChar(const std::size_t,
@@ -98,19 +140,16 @@ namespace tedit
             eraseChar(const std::size_t);
 
             void
-            combine(Line&&);
-
-            void
-            setIndex(const std::size_t);
+            combine();
 
             void
-            unselect();
+            split(const std::size_t);
 
-            void
-            select(const std::size_t start,
-                   const std::size_t n);
+            std::size_t
+            getIndex()
+            const noexcept;
 
-            std::string const&
+            std::string
             content()
             const;
 
@@ -121,17 +160,16 @@ namespace tedit
 
             bool
             empty()
-            const noexcept;
+            const;
 
             std::size_t
             size()
-            const noexcept;
+            const;
 
-        protected:
-            void
-            draw(sf::RenderTarget&,
-                 sf::RenderStates)
-            const override;
+        private:
+            std::size_t
+            offset()
+            const;
         };
 
         class Cursor : public sf::Drawable
@@ -161,6 +199,10 @@ namespace tedit
             void
             setSize(const sf::Vector2f&);
 
+            const sf::RectangleShape&
+            getShape()
+            const noexcept;
+
         protected:
             void
             draw(sf::RenderTarget&,
@@ -176,6 +218,7 @@ namespace tedit
                 Insert,
                 Normal,
                 Visual,
+                Search,
             };
 
             friend std::ostream&
@@ -201,11 +244,47 @@ namespace tedit
                     os << "Visual";
                 }
                 break;
+                case Mode::Search:
+                {
+                    os << "Search";
+                }
+                break;
                 }
                 return os;
             }
         };
 
+    private:
+        // The state the damage is worked out from
+        struct Frame
+        {
+            Position    cursor;
+            Selection   selection;
+            Mode::Type  mode;
+            std::size_t vscrolled;
+            std::size_t hscrolled;
+            std::size_t version;
+            std::size_t lines;
+            std::size_t hmax;
+            std::size_t query;
+        };
+
+        // Incremental search, the cursor follows the match as the query
+        // is typed
+        struct Search
+        {
+            std::string                             query;
+            std::size_t                             origin;  // Offset the search started from
+            std::vector<std::optional<std::size_t>> matches; // Of every prefix of the query
+        };
+
+        // Work put off until the next layout()
+        struct Layout
+        {
+            bool pending;
+            bool follow_cursor;
+        };
+
     private:
         static Size     s_default_size;
         static Position s_default_position;
@@ -218,15 +297,26 @@ namespace tedit
         sf::RectangleShape m_shape;
         Cursor             m_cursor;
         Mode::Type         m_current_mode;
+        WorkerPool&        m_workers;
+
+        std::unique_ptr<Journal>     m_journal;
+        History                      m_history;
+        Highlighter                  m_highlighter;
+        PieceTable                   m_buffer;
+        std::unique_ptr<LineIndexer> m_indexer;
 
-        std::vector<std::shared_ptr<Line>> m_lines;
+        bool                             m_highlight;    // The file is C or C++
+        std::optional<WorkerPool::Token> m_highlighting; // Lexing the lines off screen
 
-        Position m_selected_start;
-        Position m_selected_end;
+        Selection m_selection;
 
-        std::unique_ptr<std::fstream> m_file;
-        std::optional<std::string>    m_filename;
-        bool                          m_saved;
+        std::optional<std::string>       m_filename;
+        bool                             m_saved;
+        std::optional<WorkerPool::Token> m_saving;         // Save running in the background
+        std::size_t                      m_saving_version; // Buffer version being saved
+        bool                             m_save_requested; // Saved again once the current one is done
+
+        std::optional<WorkerPool::Token> m_asking; // Dialog open on a worker, one at a time
 
         std::string m_clipboard;
 
@@ -237,29 +327,41 @@ namespace tedit
         std::size_t m_hscrolled;
         std::size_t m_hmax;
 
-    public:
-        Editor(const std::size_t width = s_default_size.width,
-               const std::size_t height = s_default_size.height);
+        std::optional<Search> m_search;
+
+        std::unique_ptr<Replacer> m_replacer;        // Replace all running in the background
+        std::size_t               m_replace_version; // Buffer version being scanned
 
-        Editor(const std::vector<std::shared_ptr<Line>>&,
+        std::optional<std::pair<std::regex, std::string>> m_pending_replace; // Replace all waiting for the file to load
+
+        std::string m_notice;    // Outcome of the last command, shown until a key is pressed
+        bool        m_truncated; // The file was cut short on disk, and the user was told
+
+        bool   m_dirty; // Something changed since the last frame was published
+        Layout m_layout;
+
+    public:
+        // Background work runs on `workers`, which has to outlive the editor
+        Editor(WorkerPool& workers,
                const std::size_t width = s_default_size.width,
                const std::size_t height = s_default_size.height);
 
-        Editor(std::vector<std::shared_ptr<Line>>&&,
+        Editor(WorkerPool& workers,
+               std::string content,
                const std::size_t width = s_default_size.width,
                const std::size_t height = s_default_size.height);
 
         ~Editor();
 
-        std::shared_ptr<Line>&
+        Line
         at(const std::size_t);
 
-        std::shared_ptr<Line>&
+        Line
         operator[](const std::size_t);
 
         void
         insertLine(const std::size_t,
-                   Line*);
+                   const std::string&);
 
         void
         eraseLine(const std::size_t);
@@ -267,6 +369,14 @@ namespace tedit
         void
         write(const char);
 
+        // Layout and scrollers are updated once for the whole text
+        void
+        write(const std::string_view);
+
+        Position
+        insertText(const Position&,
+                   const std::string_view);
+
         Mode::Type
         getCurrentMode()
         const noexcept;
@@ -292,11 +402,79 @@ namespace tedit
         void
         handleEvent(const sf::Event);
 
+        // Text of consecutive TextEntered events, handled as one
+        void
+        handleText(const std::string_view);
+
+        void
+        update();
+
         bool
         isSaved()
         const noexcept;
 
+        // Background work is running and update() has to keep being called
+        bool
+        isBusy()
+        const noexcept;
+
+        // Brings the longest line, the scrollers and the scroll offsets up
+        // to date with the changes made since the last call, once per frame
+        void
+        layout();
+
+        bool
+        isDirty()
+        const noexcept;
+
+        void
+        clearDamage()
+        noexcept;
+
+        // Copies what is on screen, for drawing without the editor
+        void
+        snapshot(EditorView::State&)
+        const;
+
     private:
+        std::size_t
+        toOffset(const Position&)
+        const;
+
+        Position
+        toPosition(const std::size_t)
+        const;
+
+        std::pair<std::size_t, std::size_t>
+        visibleRows()
+        const noexcept;
+
+        // Visible rows rounded out to whole tiles
+        std::pair<std::size_t, std::size_t>
+        drawnRows()
+        const noexcept;
+
+        Frame
+        capture()
+        const noexcept;
+
+        // Something on screen differs from `before`
+        void
+        damage(const Frame& before)
+        noexcept;
+
+        void
+        invalidateLayout(const bool follow_cursor = true)
+        noexcept;
+
+        // Lexes what changed on screen, and hands the rest to a worker
+        void
+        highlight();
+
+        static bool
+        isSource(const std::string& filename)
+        noexcept;
+
         void
         handleSelect();
 
@@ -304,20 +482,25 @@ namespace tedit
         handleKeyPress(const sf::Event::KeyEvent);
 
         void
-        deleteForward(std::shared_ptr<Line>& current_line,
-                       Position& cursor_position);
+        writeControl(const char,
+                     Line& current_line,
+                     Position& cursor_position);
 
         void
-        deleteBackward(std::shared_ptr<Line>& current_line,
+        deleteForward(Line& current_line,
+                      Position& cursor_position);
+
+        void
+        deleteBackward(Line& current_line,
                        Position& cursor_position);
 
         void
-        insertNewLine(std::shared_ptr<Line>& current_line,
+        insertNewLine(Line& current_line,
                       Position& cursor_position);
 
         void
-        insertTab(std::shared_ptr<Line>& current_line,
-                      Position& cursor_position);
+        insertTab(Line& current_line,
+                  Position& cursor_position);
 
         void
         copy(bool erase = false);
@@ -325,31 +508,101 @@ namespace tedit
         void
         paste();
 
+        void
+        undo();
+
+        void
+        startSearch();
+
+        void
+        handleSearch(const char);
+
+        // Moves on to the match after the current one
+        void
+        nextMatch();
+
+        void
+        endSearch(const bool accept);
+
+        std::optional<std::size_t>
+        findFrom(const std::size_t offset);
+
+        void
+        showMatch();
+
+        void
+        replaceAll();
+
+        void
+        startReplace(std::regex,
+                     std::string format);
+
+        void
+        finishReplace();
+
+        // Runs a dialog and returns its answer, nothing when cancelled.
+        // Blocks until it is closed, so only ever called from a job, and
+        // closes it when the job is cancelled
+        static std::optional<std::string>
+        ask(const std::string& command,
+            const WorkerPool::Token&);
+
+        // Asks for a line of text, like ask()
+        static std::optional<std::string>
+        prompt(const std::string& text,
+               const WorkerPool::Token&);
+
+        void
+        redo();
+
         void
         save();
 
         void
         open();
 
+        void
+        load(const std::string& filename);
+
+        void
+        finishSave(const bool written);
+
+        // Until the save running and the ones requested meanwhile are done
+        void
+        waitForSave();
+
+        void
+        loadChunks(const bool wait);
+
         void
         handleMouseScrolling(const int,
                              const int);
 
+        void
+        handleMouseWheel(const sf::Event::MouseWheelScrollEvent&);
+
         void
         scrollToCursor();
 
+        // Moves the thumbs to where the view is scrolled to
+        void
+        syncScrollers();
+
+        // Furthest the view can be scrolled, in pixels
+        std::size_t
+        maxScroll(const Scroller::Direction)
+        const noexcept;
+
         void
-        resizeScroller();
+        resizeScroller(const bool follow_cursor = true);
 
     public:
         static void
         setFont(const std::string& font_path);
 
-    protected:
-        void
-        draw(sf::RenderTarget&,
-             sf::RenderStates)
-        const override;
+        static const Font&
+        getFont()
+        noexcept;
     };
 }
 
@@ -0,0 +1,120 @@
+#ifndef TEDIT_EDITOR_VIEW_HPP
+#define TEDIT_EDITOR_VIEW_HPP
+
+#include <string>
+#include <vector>
+#include <memory>
+#include <unordered_map>
+
+#include <SFML/Graphics/Drawable.hpp>
+#include <SFML/Graphics/RectangleShape.hpp>
+#include <SFML/Graphics/RenderTarget.hpp>
+#include <SFML/Graphics/RenderTexture.hpp>
+#include <SFML/Graphics/Sprite.hpp>
+#include <SFML/Graphics/Transform.hpp>
+#include <SFML/System/String.hpp>
+
+#include "TextRenderer.hpp"
+#include "Highlighter.hpp"
+
+#define TEDIT_TILE_ROWS  16 // Rows rasterized together into one texture
+#define TEDIT_TILE_CACHE 12 // Tiles kept, on and off screen
+
+namespace tedit
+{
+    // Draws the editor from a copy of what is on screen, so drawing never
+    // has to look at the buffer and can happen on another thread
+    class EditorView : public sf::Drawable
+    {
+    public:
+        // Text is placed from the first visible row and column rather
+        // than from the start of the document, so that the coordinates
+        // stay small enough for floats on huge documents
+        struct State
+        {
+            sf::RectangleShape                          background;
+            sf::RectangleShape                          cursor;
+            sf::RectangleShape                          vscroller;
+            sf::RectangleShape                          hscroller;
+            float                                       vscrolled; // Pixels past the first row and column
+            float                                       hscrolled;
+            std::size_t                                 first_row;    // A multiple of TEDIT_TILE_ROWS
+            std::size_t                                 first_column;
+            std::vector<std::string>                    rows;      // Visible part of the visible rows
+            std::vector<std::vector<Highlighter::Kind>> kinds;     // Of every byte of rows, empty when plain
+            bool                                        non_ascii;
+            std::vector<sf::FloatRect>                  selection;
+            float                                       progress;  // Of the file being loaded, negative when done
+            std::string                                 status;    // Shown at the bottom, nothing when empty
+        };
+
+    private:
+        // Rows already rasterized, reused as long as the same text is
+        // shown from the same column
+        struct Tile
+        {
+            std::unique_ptr<sf::RenderTexture>          texture;
+            std::size_t                                 first_column;
+            bool                                        non_ascii;
+            std::vector<std::string>                    rows;
+            std::vector<std::vector<Highlighter::Kind>> kinds;
+        };
+
+        unsigned int m_size;
+        TextRenderer m_overlay; // Selection, redrawn every frame
+        TextRenderer m_text;    // Text of the tile being rasterized
+        TextRenderer m_status;
+
+        std::vector<sf::Color> m_colors; // Of every character of the row being rasterized
+
+        std::unordered_map<std::size_t, Tile>           m_tiles;   // By first row / TEDIT_TILE_ROWS
+        std::vector<std::unique_ptr<sf::RenderTexture>> m_spare;   // Textures of tiles let go
+        std::vector<std::pair<const Tile*, float>>      m_visible; // With where they go this frame
+        sf::Vector2u                                    m_tile_size;
+
+        sf::RectangleShape m_background;
+        sf::RectangleShape m_cursor;
+        sf::RectangleShape m_vscroller;
+        sf::RectangleShape m_hscroller;
+        sf::RectangleShape m_progress;
+        sf::Transform      m_scroll;
+        bool               m_loading;
+
+    public:
+        EditorView(const sf::Font&,
+                   const unsigned int size,
+                   const float glyph,
+                   const bool bold);
+
+        void
+        setState(const State&);
+
+    protected:
+        void
+        draw(sf::RenderTarget&,
+             sf::RenderStates)
+        const override;
+
+    private:
+        const Tile&
+        tile(const State&,
+             const std::size_t index);
+
+        std::unique_ptr<sf::RenderTexture>
+        takeTexture();
+
+        // Keeps at most TEDIT_TILE_CACHE tiles, those in [first, last) stay
+        void
+        trim(const std::size_t first,
+             const std::size_t last);
+
+        void
+        rasterize(Tile&);
+
+        static sf::Color
+        colorOf(const Highlighter::Kind)
+        noexcept;
+    };
+}
+
+#endif // TEDIT_EDITOR_VIEW_HPP
\ No newline at end of file
@@ -3,16 +3,39 @@
 
 #include <SFML/Graphics/RenderWindow.hpp>
 #include <SFML/Window/Event.hpp>
+#include <SFML/System/Sleep.hpp>
+#include <vector>
+#include <string>
+#include <thread>
+#include <mutex>
+#include <atomic>
+#include <condition_variable>
 #include "Editor.hpp"
+#include "EditorView.hpp"
+#include "TripleBuffer.hpp"
+#include "WorkerPool.hpp"
 
 #define WINDOW_TITLE "tedit"
+#define WINDOW_BUSY_INTERVAL 15 // Milliseconds between updates while the editor works in the background
 
 namespace tedit
 {
     class EditorWindow
     {
     private: sf::RenderWindow m_window;
-        
+
+        // Background jobs of the editor, they report back through its
+        // update() on every turn of the event loop
+        WorkerPool m_workers;
+
+        // Frames are drawn on their own thread from copies of the editor,
+        // so a slow draw never holds up editing and the other way around
+        TripleBuffer<EditorView::State> m_frames;
+        std::thread                     m_renderer;
+        std::atomic<bool>               m_rendering;
+        std::mutex                      m_wake_mutex; // Only for waiting on m_wake
+        std::condition_variable         m_wake;
+
     public:
         EditorWindow(const std::size_t&,
                      const std::size_t&);
@@ -21,8 +44,24 @@ namespace tedit
         open();
 
     private:
+        void
+        render();
+
+        void
+        startRendering();
+
+        void
+        stopRendering();
+
+        void
+        publish(const Editor&);
+
         void
         handleEvents(Editor&);
+
+        void
+        dispatch(Editor&,
+                 const std::vector<sf::Event>&);
     };
 }
 
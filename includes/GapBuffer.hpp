@@ -0,0 +1,69 @@
+#ifndef TEDIT_GAP_BUFFER_HPP
+#define TEDIT_GAP_BUFFER_HPP
+
+#include <string>
+#include <string_view>
+#include <vector>
+#include <algorithm>
+#include <cstring>
+#include <stdexcept>
+
+#define TEDIT_GAP_MIN_SIZE 64
+
+namespace tedit
+{
+    class GapBuffer
+    {
+    private:
+        std::vector<char> m_data;
+        std::size_t       m_gap_begin;
+        std::size_t       m_gap_end;
+
+    public:
+        GapBuffer();
+
+        explicit GapBuffer(const std::string_view);
+
+        void
+        insert(const std::size_t,
+               const std::string_view);
+
+        void
+        erase(const std::size_t,
+              const std::size_t);
+
+        char
+        operator[](const std::size_t)
+        const noexcept;
+
+        std::string
+        substr(const std::size_t,
+               const std::size_t)
+        const;
+
+        std::size_t
+        size()
+        const noexcept;
+
+        bool
+        empty()
+        const noexcept;
+
+        std::size_t
+        capacity()
+        const noexcept;
+
+    private:
+        std::size_t
+        gapSize()
+        const noexcept;
+
+        void
+        moveGap(const std::size_t);
+
+        void
+        reserve(const std::size_t);
+    };
+}
+
+#endif // TEDIT_GAP_BUFFER_HPP
\ No newline at end of file
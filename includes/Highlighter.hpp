@@ -0,0 +1,131 @@
+#ifndef TEDIT_HIGHLIGHTER_HPP
+#define TEDIT_HIGHLIGHTER_HPP
+
+#include <string>
+#include <string_view>
+#include <vector>
+#include <iterator>
+#include <cstdint>
+#include <cstring>
+#include <cctype>
+#include <algorithm>
+#include <utility>
+
+#include "PieceTable.hpp"
+
+#define TEDIT_HIGHLIGHT_MAX_LINE 4096          // Longer lines are left plain
+#define TEDIT_HIGHLIGHT_BUDGET   256           // Lines lexed per frame on the editor's thread
+#define TEDIT_HIGHLIGHT_JOB      (1024 * 1024) // Bytes lexed by one background job
+#define TEDIT_HIGHLIGHT_WINDOW   4096          // Lines of cached state a job compares against
+
+namespace tedit
+{
+    // C and C++ syntax highlighting. Only the lexer state at the end of
+    // every line is kept, the kinds of the bytes are worked out again
+    // from it for the lines on screen. An edit marks its lines dirty,
+    // and lexing them again stops as soon as a line ends in the state
+    // it ended in before, since nothing after it can change
+    class Highlighter
+    {
+    public:
+        enum class Kind : std::uint8_t
+        {
+            Text,
+            Keyword,
+            Type,
+            Number,
+            String,
+            Comment,
+            Preprocessor,
+        };
+
+        // What carries over from one line to the next
+        enum class State : std::uint8_t
+        {
+            Code,
+            BlockComment,
+            LineComment, // Continued by a backslash
+            String,      // Likewise
+        };
+
+        // Lines lexed in the background, applied by merge()
+        struct Job
+        {
+            std::size_t        row;
+            std::size_t        offset;     // Of `row`
+            State              start;      // At the end of the line before `row`
+            std::size_t        generation; // Of the edits, the job is dropped if they moved on
+            std::vector<State> cached;     // States of the rows from `row` on, as known when started
+            std::vector<char>  dirty;      // And which of them were dirty
+            std::vector<State> states;     // Result
+        };
+
+    private:
+        std::vector<State> m_states;      // At the end of every line lexed so far
+        std::vector<char>  m_dirty;       // Edited, or the line before ended differently
+        std::size_t        m_first_dirty; // None before it
+        std::size_t        m_generation;  // Bumped on every edit
+
+    public:
+        Highlighter();
+
+        // Told by the buffer, `lines` line feeds were inserted on `row`
+        void
+        insert(const std::size_t row,
+               const std::size_t lines);
+
+        // Likewise, the line feeds ending `row` and the `lines - 1` after it
+        void
+        erase(const std::size_t row,
+              const std::size_t lines);
+
+        void
+        clear()
+        noexcept;
+
+        // Lexes the dirty lines and the new ones before `last_row`, at most
+        // `budget` of them. Returns the rows whose colors changed
+        std::pair<std::size_t, std::size_t>
+        relex(const PieceTable&,
+              const std::size_t last_row,
+              const std::size_t budget = TEDIT_HIGHLIGHT_BUDGET);
+
+        // Where the background has to carry on from, if anywhere
+        bool
+        prepare(const PieceTable&,
+                Job&)
+        const;
+
+        // Runs on a worker
+        static void
+        run(const PieceTable::Snapshot&,
+            Job&);
+
+        // Returns the rows whose colors changed, none if the text was
+        // edited since the job was prepared
+        std::pair<std::size_t, std::size_t>
+        merge(const Job&);
+
+        // A guess past the lines lexed so far
+        State
+        stateAt(const std::size_t row)
+        const noexcept;
+
+        // The state at the end of `line`, `kinds` gets one per byte when given
+        static State
+        lex(const std::string_view line,
+            const State,
+            Kind* kinds = nullptr);
+
+    private:
+        std::size_t
+        nextDirty(const std::size_t from)
+        const noexcept;
+
+        static Kind
+        classify(const std::string_view word)
+        noexcept;
+    };
+}
+
+#endif // TEDIT_HIGHLIGHTER_HPP
\ No newline at end of file
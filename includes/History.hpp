@@ -0,0 +1,139 @@
+#ifndef TEDIT_HISTORY_HPP
+#define TEDIT_HISTORY_HPP
+
+#include <string>
+#include <string_view>
+#include <vector>
+#include <deque>
+#include <optional>
+
+#include "PieceTable.hpp"
+
+#define TEDIT_HISTORY_LIMIT  (64 * 1024 * 1024) // Bytes kept for undo and redo
+#define TEDIT_HISTORY_INLINE 4096               // Erases up to this many bytes keep a copy of the text
+
+namespace tedit
+{
+    // Undo and redo of the edits made to a PieceTable. Inserted text is
+    // never copied, and large erases keep the pieces that pointed at the
+    // text rather than the text: the original and add buffers are never
+    // modified, so the pieces stay valid
+    class History
+    {
+    private:
+        enum class Operation
+        {
+            Insert,
+            Erase,
+        };
+
+        struct Record
+        {
+            Operation                      operation;
+            std::size_t                    offset;
+            std::size_t                    length;
+            std::string                    text;   // Erased text, when small
+            std::vector<PieceTable::Piece> pieces; // Erased text, otherwise
+        };
+
+        // What one undo or redo reverts, in the order it was done
+        struct Step
+        {
+            std::vector<Record> records;
+            std::size_t         bytes;
+        };
+
+        // Where the edits made to the table are recorded
+        enum class Target
+        {
+            Undo,   // Edits made by the user
+            Redo,   // Edits made while undoing
+            Replay, // Edits made while redoing
+        };
+
+    private:
+        std::deque<Step>  m_undo;      // Oldest first, evicted from the front
+        std::vector<Step> m_redo;
+        Step              m_reverted;  // Inverse of the step being undone or redone
+        bool              m_open;      // Edits next to the last one join its step
+        bool              m_grouped;   // Any edit joins the last step
+        Target            m_target;
+        std::size_t       m_bytes;
+        std::size_t       m_limit;
+
+    public:
+        explicit History(const std::size_t limit = TEDIT_HISTORY_LIMIT);
+
+        void
+        insert(const std::size_t offset,
+               const std::size_t length);
+
+        // Called before the text is erased from `buffer`
+        void
+        erase(PieceTable& buffer,
+              const std::size_t offset,
+              const std::size_t length);
+
+        // The next edit starts a step of its own
+        void
+        seal()
+        noexcept;
+
+        // Until the next seal(), every edit joins the same step, however
+        // far apart the edits are
+        void
+        group()
+        noexcept;
+
+        // Both return where the edits reverted start, for the cursor
+        std::optional<std::size_t>
+        undo(PieceTable&);
+
+        std::optional<std::size_t>
+        redo(PieceTable&);
+
+        bool
+        canUndo()
+        const noexcept;
+
+        bool
+        canRedo()
+        const noexcept;
+
+        void
+        clear()
+        noexcept;
+
+        std::size_t
+        usage()
+        const noexcept;
+
+    private:
+        void
+        record(Record);
+
+        // Merges `next` into `last` when it continues it, like typing does
+        static bool
+        extend(Record& last,
+               const Record& next);
+
+        static bool
+        touches(const Record& last,
+                const Record& next)
+        noexcept;
+
+        static std::size_t
+        size(const Record&)
+        noexcept;
+
+        std::size_t
+        revert(const Step&,
+               PieceTable&,
+               const Target);
+
+        void
+        evict();
+    };
+}
+
+#endif // TEDIT_HISTORY_HPP
\ No newline at end of file
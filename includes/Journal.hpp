@@ -0,0 +1,160 @@
+#ifndef TEDIT_JOURNAL_HPP
+#define TEDIT_JOURNAL_HPP
+
+#include <string>
+#include <string_view>
+#include <memory>
+#include <optional>
+#include <thread>
+#include <mutex>
+#include <condition_variable>
+#include <chrono>
+#include <cstdint>
+#include <cstring>
+#include <cerrno>
+#include <fstream>
+#include <iterator>
+#include <utility>
+#include <cstdio>
+#include <ctime>
+
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/stat.h>
+
+#define TEDIT_JOURNAL_INTERVAL 200 // Milliseconds between flushes
+#define TEDIT_JOURNAL_SUFFIX   ".tedit-swp"
+
+namespace tedit
+{
+    class PieceTable;
+
+    // Append only log of the edits made since the file was last saved,
+    // replayed on top of the file after a crash
+    class Journal
+    {
+    private:
+        enum class Operation : std::uint8_t
+        {
+            Insert = 1,
+            Erase  = 2,
+        };
+
+        // Identifies the version of the file the records apply to
+        struct Header
+        {
+            char          magic[8];
+            std::uint64_t size;
+            std::int64_t  seconds;
+            std::int64_t  nanoseconds;
+        };
+
+        // A journal to restart from, once the save it follows is done
+        struct Rebase
+        {
+            Header      header;
+            std::string records;
+        };
+
+    private:
+        std::string m_filename;
+        std::string m_path;
+        int         m_fd;
+
+        std::mutex                 m_mutex;
+        std::condition_variable    m_condition;
+        std::string                m_pending; // Records not yet written
+        std::optional<std::string> m_tail;    // Records since the last checkpoint
+        std::optional<Rebase>      m_rebase;  // Kept until the new journal is in place
+        std::size_t                m_rebases; // Bumped by every rebase()
+        bool                       m_rebase_requested;
+        bool                       m_stopped;
+
+        std::optional<std::string> m_stale; // Where a journal of another version of the file was moved
+
+        std::thread m_thread;
+
+        Journal(std::string filename, const int fd);
+
+    public:
+        Journal(const Journal&) = delete;
+
+        Journal&
+        operator=(const Journal&) = delete;
+
+        ~Journal();
+
+        // When `recover` is given and a journal of the same version of the
+        // file exists, its records are applied to it and the journal is
+        // continued, otherwise a new one is started
+        static std::unique_ptr<Journal>
+        open(const std::string& filename,
+             PieceTable* recover = nullptr);
+
+        static bool
+        exists(const std::string& filename);
+
+        void
+        insert(const std::size_t offset,
+               const std::string_view);
+
+        void
+        erase(const std::size_t offset,
+              const std::size_t length);
+
+        // Called when a save starts, records made after it are kept so
+        // they can outlive the save
+        void
+        checkpoint();
+
+        // The save finished, restart from the new file with what was
+        // recorded since the checkpoint. The new journal is written in
+        // the background, the old one is only replaced once it is on disk
+        void
+        rebase();
+
+        // The save failed, the old records are still needed
+        void
+        cancel();
+
+        void
+        discard();
+
+        // Records that could not be replayed on the file opened, set
+        // aside instead of being dropped
+        const std::optional<std::string>&
+        stale()
+        const noexcept;
+
+    private:
+        void
+        record(const Operation,
+               const std::size_t offset,
+               const std::size_t length,
+               const std::string_view text);
+
+        void
+        run();
+
+        void
+        stop();
+
+        // Replaces the journal with a new one, false when the old one
+        // is left as it was
+        bool
+        restart(const Rebase&);
+
+        static std::optional<Header>
+        identify(const std::string& filename);
+
+        static std::size_t
+        replay(std::string_view records,
+               PieceTable&);
+
+        static bool
+        writeAll(const int fd,
+                 std::string_view);
+    };
+}
+
+#endif // TEDIT_JOURNAL_HPP
\ No newline at end of file
@@ -0,0 +1,41 @@
+#ifndef TEDIT_LENGTH_HISTOGRAM_HPP
+#define TEDIT_LENGTH_HISTOGRAM_HPP
+
+#include <vector>
+#include <map>
+#include <algorithm>
+
+#define TEDIT_HISTOGRAM_DENSE 1024 // Lengths below this are counted in a flat array
+
+namespace tedit
+{
+    // How many lines there are of each length, so the longest one is
+    // known without looking at the text
+    class LengthHistogram
+    {
+    private:
+        std::vector<std::size_t>           m_dense;
+        std::map<std::size_t, std::size_t> m_sparse;
+        std::size_t                        m_dense_max; // Longest length counted in m_dense
+
+    public:
+        LengthHistogram();
+
+        void
+        add(const std::size_t length);
+
+        // False when no line of that length was counted, the counts are
+        // off from then on and have to be made again from scratch
+        bool
+        remove(const std::size_t length);
+
+        void
+        clear();
+
+        std::size_t
+        max()
+        const noexcept;
+    };
+}
+
+#endif // TEDIT_LENGTH_HISTOGRAM_HPP
\ No newline at end of file
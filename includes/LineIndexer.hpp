@@ -0,0 +1,69 @@
+#ifndef TEDIT_LINE_INDEXER_HPP
+#define TEDIT_LINE_INDEXER_HPP
+
+#include <vector>
+#include <memory>
+#include <mutex>
+#include <atomic>
+#include <cstring>
+#include <utility>
+
+#include "MappedFile.hpp"
+#include "LineScanner.hpp"
+#include "WorkerPool.hpp"
+
+#define TEDIT_INDEX_FIRST_CHUNK (64 * 1024)
+#define TEDIT_INDEX_CHUNK       (4 * 1024 * 1024)
+
+namespace tedit
+{
+    class LineIndexer
+    {
+    public:
+        // Chunks always end right after a line feed (or at the end of the file)
+        struct Chunk
+        {
+            std::size_t              end;
+            std::vector<std::size_t> line_feeds;
+            bool                     non_ascii;
+        };
+
+    private:
+        std::shared_ptr<const MappedFile> m_file;
+
+        std::mutex         m_mutex;
+        std::vector<Chunk> m_chunks;
+
+        std::atomic<std::size_t> m_indexed;
+
+        WorkerPool&       m_workers;
+        WorkerPool::Token m_job;
+
+    public:
+        LineIndexer(std::shared_ptr<const MappedFile>,
+                    WorkerPool&);
+
+        LineIndexer(const LineIndexer&) = delete;
+
+        LineIndexer&
+        operator=(const LineIndexer&) = delete;
+
+        ~LineIndexer();
+
+        std::vector<Chunk>
+        poll();
+
+        std::vector<Chunk>
+        wait();
+
+        float
+        progress()
+        const noexcept;
+
+    private:
+        void
+        run(const WorkerPool::Token&);
+    };
+}
+
+#endif // TEDIT_LINE_INDEXER_HPP
\ No newline at end of file
@@ -0,0 +1,81 @@
+#ifndef TEDIT_LINE_SCANNER_HPP
+#define TEDIT_LINE_SCANNER_HPP
+
+#include <string_view>
+#include <vector>
+#include <algorithm>
+
+#if defined(__x86_64__) || defined(__i386__)
+#include <immintrin.h>
+#define TEDIT_SCANNER_X86 1
+#endif
+
+namespace tedit
+{
+    class LineScanner
+    {
+    public:
+        enum class Implementation
+        {
+            Scalar,
+            Sse2,
+            Avx2,
+        };
+
+        // Scans can be chained: `current` carries the length of the line
+        // that is still open at the end of the previous scan
+        struct Statistics
+        {
+            std::vector<std::size_t> line_feeds;
+            std::size_t              longest   = 0;
+            std::size_t              current   = 0;
+            bool                     non_ascii = false;
+        };
+
+    public:
+        static void
+        scan(const std::string_view,
+             const std::size_t base,
+             Statistics&);
+
+        static void
+        scan(const std::string_view,
+             const std::size_t base,
+             Statistics&,
+             const Implementation);
+
+        static Implementation
+        detect()
+        noexcept;
+
+        static const char*
+        name(const Implementation)
+        noexcept;
+
+    private:
+        static void
+        scanScalar(const char*,
+                   const std::size_t size,
+                   const std::size_t base,
+                   std::size_t& line_start,
+                   Statistics&);
+
+#ifdef TEDIT_SCANNER_X86
+        static void
+        scanSse2(const char*,
+                 const std::size_t size,
+                 const std::size_t base,
+                 std::size_t& line_start,
+                 Statistics&);
+
+        static void
+        scanAvx2(const char*,
+                 const std::size_t size,
+                 const std::size_t base,
+                 std::size_t& line_start,
+                 Statistics&);
+#endif
+    };
+}
+
+#endif // TEDIT_LINE_SCANNER_HPP
\ No newline at end of file
@@ -0,0 +1,84 @@
+#ifndef TEDIT_MAPPED_FILE_HPP
+#define TEDIT_MAPPED_FILE_HPP
+
+#include <string>
+#include <string_view>
+#include <memory>
+#include <atomic>
+#include <mutex>
+#include <cstdint>
+
+#include <fcntl.h>
+#include <signal.h>
+#include <unistd.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+
+#define TEDIT_MAPPED_MAX 64 // Mappings guarded against their file being truncated
+
+namespace tedit
+{
+    // Read only view of a whole file. When another process truncates the
+    // file, reading the pages past its new end would raise SIGBUS, they
+    // are replaced with zeros instead and the mapping is marked damaged
+    class MappedFile
+    {
+    private:
+        // Looked up from the SIGBUS handler, so lock free atomics only
+        struct Guard
+        {
+            std::atomic<const char*> begin;
+            std::atomic<const char*> end;
+            std::atomic<bool>        damaged;
+        };
+
+        static Guard            s_guards[TEDIT_MAPPED_MAX];
+        static std::size_t      s_page;
+        static struct sigaction s_previous;
+
+        const char* m_data;
+        std::size_t m_size;
+        std::size_t m_guard; // In s_guards, TEDIT_MAPPED_MAX when none was free
+
+    private:
+        MappedFile(const char* data,
+                   const std::size_t size);
+
+    public:
+        MappedFile(const MappedFile&) = delete;
+
+        MappedFile&
+        operator=(const MappedFile&) = delete;
+
+        ~MappedFile();
+
+        std::string_view
+        view()
+        const noexcept;
+
+        std::size_t
+        size()
+        const noexcept;
+
+        // The file was cut short on disk, what was past its new end
+        // reads as zeros
+        bool
+        isDamaged()
+        const noexcept;
+
+        static std::shared_ptr<const MappedFile>
+        open(const std::string& filename);
+
+    private:
+        static std::size_t
+        protect(const char* data,
+                const std::size_t size);
+
+        static void
+        handle(const int,
+               siginfo_t*,
+               void*);
+    };
+}
+
+#endif // TEDIT_MAPPED_FILE_HPP
\ No newline at end of file
@@ -0,0 +1,49 @@
+#ifndef TEDIT_MATCHER_HPP
+#define TEDIT_MATCHER_HPP
+
+#include <string_view>
+#include <functional>
+#include <algorithm>
+#include <cstring>
+
+#include "LineScanner.hpp"
+
+namespace tedit
+{
+    // Substring search. The vector versions compare the first and the
+    // last byte of the needle at every position of a block at once and
+    // only check the rest where both match
+    class Matcher
+    {
+    public:
+        using Implementation = LineScanner::Implementation;
+
+    public:
+        // Offset of the first match in the text, npos when there is none
+        static std::size_t
+        find(const std::string_view text,
+             const std::string_view needle);
+
+        static std::size_t
+        find(const std::string_view text,
+             const std::string_view needle,
+             const Implementation);
+
+    private:
+        static std::size_t
+        findScalar(const std::string_view text,
+                   const std::string_view needle);
+
+#ifdef TEDIT_SCANNER_X86
+        static std::size_t
+        findSse2(const std::string_view text,
+                 const std::string_view needle);
+
+        static std::size_t
+        findAvx2(const std::string_view text,
+                 const std::string_view needle);
+#endif
+    };
+}
+
+#endif // TEDIT_MATCHER_HPP
\ No newline at end of file
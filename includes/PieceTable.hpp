@@ -0,0 +1,389 @@
+#ifndef TEDIT_PIECE_TABLE_HPP
+#define TEDIT_PIECE_TABLE_HPP
+
+#include <string>
+#include <cstdint>
+#include <string_view>
+#include <vector>
+#include <memory>
+#include <random>
+#include <optional>
+#include <algorithm>
+#include <stdexcept>
+#include <cerrno>
+
+#include <sys/uio.h>
+
+#include "GapBuffer.hpp"
+#include "MappedFile.hpp"
+#include "LineScanner.hpp"
+#include "LengthHistogram.hpp"
+#include "Matcher.hpp"
+
+#define TEDIT_WRITEV_BATCH   1024
+#define TEDIT_RECOUNT_FACTOR 32 // An erase spanning more than 1/32 of the lines recounts them all
+
+namespace tedit
+{
+    class Journal;
+    class History;
+    class Highlighter;
+
+    class PieceTable
+    {
+    public:
+        enum class Source
+        {
+            Original,
+            Add,
+        };
+
+        struct Piece
+        {
+            Source      source;
+            std::size_t start;
+            std::size_t length;
+            std::size_t line_feeds;
+        };
+
+        // Bytes held for the document, split by what they are used for
+        struct Usage
+        {
+            std::size_t text;   // Original and added text held in memory
+            std::size_t mapped; // Original text read through the mapping
+            std::size_t index;  // Line feed offsets
+            std::size_t pieces; // Tree nodes
+            std::size_t active; // Gap buffer of the line being edited
+        };
+
+        // Immutable view of the text at one point in time, safe to read
+        // from another thread while the table keeps being edited
+        class Snapshot
+        {
+        private:
+            std::shared_ptr<const MappedFile>  m_mapping;
+            std::shared_ptr<const std::string> m_original;
+            std::shared_ptr<const std::string> m_add;
+            std::vector<std::string_view>      m_pieces;
+            std::vector<std::size_t>           m_offsets; // Where each piece starts
+            std::size_t                        m_length = 0;
+
+            friend class PieceTable;
+
+        public:
+            std::size_t
+            length()
+            const noexcept;
+
+            std::string
+            substr(const std::size_t offset,
+                   const std::size_t length)
+            const;
+
+            // Points into the text when the range lies in one piece,
+            // otherwise it is copied to `scratch`
+            std::string_view
+            view(const std::size_t offset,
+                 const std::size_t length,
+                 std::string& scratch)
+            const;
+
+            // Offset of the first `c` at or after `from`, length() if none
+            std::size_t
+            find(const char c,
+                 const std::size_t from)
+            const noexcept;
+
+            bool
+            write(const std::string& filename)
+            const;
+
+        private:
+            static bool
+            writeAll(const int fd,
+                     std::vector<iovec>&);
+
+            std::size_t
+            pieceAt(const std::size_t offset)
+            const noexcept;
+        };
+
+    private:
+        struct Buffer
+        {
+            std::shared_ptr<std::string> content;    // Empty when the original is mapped
+            std::vector<std::size_t>     line_feeds; // Offsets of every '\n' in `content`
+            bool                         non_ascii = false;
+        };
+
+        // Treap ordered by document position, each node caches the
+        // byte and line feed totals of its subtree
+        struct Node
+        {
+            Piece                 piece;
+            std::uint32_t         priority;
+            std::size_t           length;
+            std::size_t           line_feeds;
+            std::unique_ptr<Node> left;
+            std::unique_ptr<Node> right;
+        };
+
+        // The line being edited lives in a gap buffer until an edit lands
+        // somewhere else, then only the bytes that changed go to the tree
+        struct ActiveLine
+        {
+            std::size_t row;
+            std::size_t offset;
+            std::size_t length;     // Committed length
+            std::size_t edit_begin; // Bytes before this are unchanged
+            std::size_t edit_tail;  // Bytes at the end that are unchanged
+            GapBuffer   content;
+        };
+
+    private:
+        Buffer                            m_original; // Never modified after construction
+        Buffer                            m_add;      // Append only
+        std::shared_ptr<const MappedFile> m_mapping;
+        std::unique_ptr<Node>             m_root;
+        std::minstd_rand                  m_random;
+        std::optional<ActiveLine>         m_active;
+        Journal*                          m_journal; // Told about every edit
+        History*                          m_history; // Likewise, before the text is erased
+        Highlighter*                      m_highlighter; // Told which lines changed
+        LengthHistogram                   m_lengths; // Length of every line
+        bool                              m_miscounted; // m_lengths lost track, counted again after the edit
+
+        std::size_t m_loaded;        // Bytes of the original that are part of the text
+        std::size_t m_loaded_offset; // Where the next loaded bytes go
+        std::size_t m_version;
+
+    public:
+        PieceTable();
+
+        explicit PieceTable(std::string original);
+
+        // When `indexed` is false the table starts empty and the file is
+        // brought in chunk by chunk through appendOriginal
+        explicit PieceTable(std::shared_ptr<const MappedFile>,
+                            const bool indexed = true);
+
+        void
+        appendOriginal(const std::size_t end,
+                       const std::vector<std::size_t>& line_feeds,
+                       const bool non_ascii);
+
+        bool
+        isLoading()
+        const noexcept;
+
+        bool
+        hasNonAscii()
+        const noexcept;
+
+        // The file mapped was cut short by another process
+        bool
+        isDamaged()
+        const noexcept;
+
+        void
+        attach(Journal*) noexcept;
+
+        void
+        attach(History*) noexcept;
+
+        void
+        attach(Highlighter*) noexcept;
+
+        void
+        insert(const std::size_t offset,
+               const std::string_view);
+
+        // Puts back text that is still in the buffers, as returned by
+        // pieces(), without copying it
+        void
+        insert(const std::size_t offset,
+               const std::vector<Piece>&);
+
+        void
+        erase(const std::size_t offset,
+              const std::size_t length);
+
+        std::size_t
+        length()
+        const noexcept;
+
+        std::size_t
+        getLinesCount()
+        const noexcept;
+
+        std::size_t
+        lineOffset(const std::size_t row)
+        const;
+
+        std::size_t
+        lineLength(const std::size_t row)
+        const;
+
+        std::size_t
+        rowAt(const std::size_t offset)
+        const;
+
+        std::string
+        line(const std::size_t row)
+        const;
+
+        std::string
+        substr(const std::size_t offset,
+               const std::size_t length)
+        const;
+
+        std::string
+        text()
+        const;
+
+        // The pieces `length` bytes from `offset` are made of
+        std::vector<Piece>
+        pieces(const std::size_t offset,
+               const std::size_t length);
+
+        // Offset of the first match at or after `from`
+        std::optional<std::size_t>
+        find(const std::string_view needle,
+             const std::size_t from);
+
+        std::size_t
+        maxLineLength()
+        const;
+
+        void
+        commit();
+
+        // With unloaded, the text still to come from the mapping is part of it
+        Snapshot
+        snapshot(const bool unloaded = false);
+
+        std::size_t
+        version()
+        const noexcept;
+
+        Usage
+        usage()
+        const;
+
+    private:
+        bool
+        activate(const std::size_t offset,
+                 const std::size_t length);
+
+        std::size_t
+        committedLength()
+        const noexcept;
+
+        std::size_t
+        committedLineOffset(const std::size_t row)
+        const;
+
+        std::size_t
+        committedRowAt(const std::size_t offset)
+        const;
+
+        void
+        committedInsert(const std::size_t offset,
+                        const std::string_view);
+
+        void
+        committedErase(const std::size_t offset,
+                       const std::size_t length);
+
+        void
+        insertPiece(const std::size_t offset,
+                    const Piece&);
+
+        const Buffer&
+        buffer(const Source)
+        const noexcept;
+
+        std::string_view
+        content(const Source)
+        const noexcept;
+
+        std::size_t
+        countLineFeeds(const Source,
+                       const std::size_t start,
+                       const std::size_t length)
+        const;
+
+        Piece
+        makePiece(const Source,
+                  const std::size_t start,
+                  const std::size_t length)
+        const;
+
+        std::unique_ptr<Node>
+        makeNode(const Piece&);
+
+        void
+        split(std::unique_ptr<Node> node,
+              const std::size_t offset,
+              std::unique_ptr<Node>& left,
+              std::unique_ptr<Node>& right);
+
+        static std::unique_ptr<Node>
+        merge(std::unique_ptr<Node> left,
+              std::unique_ptr<Node> right);
+
+        static void
+        update(Node&) noexcept;
+
+        void
+        append(const Node*,
+               const std::size_t offset,
+               const std::size_t end,
+               std::size_t position,
+               std::string& result)
+        const;
+
+        static std::size_t
+        countNodes(const Node*)
+        noexcept;
+
+        void
+        collect(const Node*,
+                std::vector<std::string_view>&)
+        const;
+
+        void
+        collect(const Node*,
+                const std::size_t offset,
+                const std::size_t end,
+                std::size_t position,
+                std::vector<Piece>&)
+        const;
+
+        void
+        countLines(const Node*,
+                   std::size_t& current);
+
+        void
+        countLines();
+
+        // Counts the lines from `row` on, `line_feeds` are the positions
+        // of the line feeds just inserted there, relative to each other
+        void
+        countInserted(const std::size_t row,
+                      const std::vector<std::size_t>& line_feeds);
+
+        void
+        uncountRow(const std::size_t row);
+
+        void
+        uncountRows(const std::size_t first_row,
+                    const std::size_t last_row);
+
+        void
+        indexLineFeeds(Buffer&,
+                       const std::size_t from);
+    };
+}
+
+#endif // TEDIT_PIECE_TABLE_HPP
\ No newline at end of file
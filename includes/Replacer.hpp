@@ -0,0 +1,101 @@
+#ifndef TEDIT_REPLACER_HPP
+#define TEDIT_REPLACER_HPP
+
+#include <string>
+#include <string_view>
+#include <vector>
+#include <memory>
+#include <atomic>
+#include <regex>
+#include <algorithm>
+#include <utility>
+
+#include "PieceTable.hpp"
+#include "WorkerPool.hpp"
+
+#define TEDIT_REPLACE_CHUNKS_PER_THREAD 4    // So a slow chunk does not hold up the others
+#define TEDIT_REPLACE_MAX_LINE          4096 // Longer lines are skipped, std::regex recurses once per character
+
+namespace tedit
+{
+    // Finds every match of a regex in a snapshot of the buffer, line by
+    // line, on all the workers. Matches never span lines, and lines
+    // too long to search safely are skipped and counted
+    class Replacer
+    {
+    public:
+        struct Match
+        {
+            std::size_t offset;
+            std::size_t length;
+            std::string replacement;
+        };
+
+    private:
+        std::shared_ptr<const PieceTable::Snapshot> m_snapshot;
+        std::shared_ptr<const std::regex>           m_regex;
+        std::string                                 m_format;
+
+        std::atomic<std::size_t> m_found;
+        std::atomic<std::size_t> m_skipped;
+
+        WorkerPool&                     m_workers;
+        std::vector<WorkerPool::Token>  m_chunks;  // In document order
+        std::vector<std::vector<Match>> m_results; // Of every chunk, once it is done
+
+    public:
+        // `format` is what every match is replaced with, $1 and the like
+        // refer to the groups of the match
+        Replacer(WorkerPool&,
+                 PieceTable::Snapshot,
+                 std::regex,
+                 std::string format);
+
+        Replacer(const Replacer&) = delete;
+
+        Replacer&
+        operator=(const Replacer&) = delete;
+
+        ~Replacer();
+
+        bool
+        isDone()
+        const;
+
+        // Matches found so far, while the scan runs
+        std::size_t
+        found()
+        const noexcept;
+
+        // Lines longer than TEDIT_REPLACE_MAX_LINE, left as they are
+        std::size_t
+        skipped()
+        const noexcept;
+
+        // What it was started with, to search newer text again
+        const std::regex&
+        regex()
+        const noexcept;
+
+        const std::string&
+        format()
+        const noexcept;
+
+        // Every match in order, waits for the scan to finish
+        std::vector<Match>
+        take();
+
+    private:
+        std::vector<Match>
+        scan(const std::size_t begin,
+             const std::size_t end,
+             const WorkerPool::Token&);
+
+        // Start of the first line at or after `offset`
+        std::size_t
+        lineStart(const std::size_t offset)
+        const noexcept;
+    };
+}
+
+#endif // TEDIT_REPLACER_HPP
\ No newline at end of file
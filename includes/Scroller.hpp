@@ -8,6 +8,8 @@
 #include <SFML/Graphics/RenderStates.hpp>
 #include <SFML/Window/Event.hpp>
 
+#define TEDIT_SCROLL_MIN_THUMB 20 // Pixels, so the thumb can still be grabbed on huge documents
+
 namespace tedit
 {
     class Scroller : public sf::Drawable
@@ -24,8 +26,11 @@ namespace tedit
         Direction          m_direction;
         size_t             m_max_size;
 
-        std::optional<float> m_hold;
-        float                m_release;
+        std::optional<int> m_hold;     // Pointer position the drag is measured from
+        int                m_pointer;  // Where the pointer last was
+        double             m_anchor;   // Position when the pointer was at m_hold
+        double             m_step;     // Of the position per pixel the pointer moves
+        double             m_fraction; // Position, finer than the thumb's pixels
 
     public:
         Scroller(const Direction& , const size_t& max_size);
@@ -36,12 +41,17 @@ namespace tedit
         void
         endScrolling(const sf::Event::MouseButtonEvent&);
 
-        std::optional<std::size_t>
+        // Where the thumb was dragged to, from 0 at the start to 1 at the end.
+        // The thumb follows the pointer, unless a `step` is given that every
+        // pixel moves the position by instead, for finer control than the
+        // pixels of the thumb allow
+        std::optional<double>
         mouseScroll(const int,
-                    const int);
+                    const int,
+                    const double step = 0);
 
         void
-        scrollTo(const int);
+        scrollTo(const double);
 
         float
         getPosition()
@@ -68,11 +78,21 @@ namespace tedit
         
         void
         setFillColor(const sf::Color&);
+
+        const sf::RectangleShape&
+        getShape()
+        const noexcept;
     protected:
         void
         draw(sf::RenderTarget&,
              sf::RenderStates)
         const override;
+
+    private:
+        // How far the thumb can move
+        float
+        travel()
+        const noexcept;
     };
 }
 
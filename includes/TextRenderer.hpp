@@ -0,0 +1,75 @@
+#ifndef TEDIT_TEXT_RENDERER_HPP
+#define TEDIT_TEXT_RENDERER_HPP
+
+#include <SFML/Graphics/Drawable.hpp>
+#include <SFML/Graphics/Font.hpp>
+#include <SFML/Graphics/Glyph.hpp>
+#include <SFML/Graphics/Rect.hpp>
+#include <SFML/Graphics/RenderTarget.hpp>
+#include <SFML/Graphics/RenderStates.hpp>
+#include <SFML/Graphics/Vertex.hpp>
+#include <SFML/Graphics/VertexArray.hpp>
+#include <SFML/System/String.hpp>
+#include <vector>
+
+namespace tedit
+{
+    // Lays out monospace text and solid rectangles as quads over the
+    // font's glyph page, so everything added is drawn in a single call
+    class TextRenderer : public sf::Drawable
+    {
+    private:
+        const sf::Font* m_font;
+        unsigned int    m_size;
+        float           m_advance;
+        bool            m_bold;
+        sf::VertexArray m_vertices;
+
+    public:
+        TextRenderer(const sf::Font&,
+                     const unsigned int size,
+                     const float advance,
+                     const bool bold);
+
+        void
+        clear();
+
+        // `y` is the top of the row, glyphs sit on a baseline `size` below it
+        void
+        addText(const sf::String&,
+                const float x,
+                const float y,
+                const sf::Color&);
+
+        // One color per character, those past the end are white
+        void
+        addText(const sf::String&,
+                const float x,
+                const float y,
+                const std::vector<sf::Color>&);
+
+        void
+        addRectangle(const sf::FloatRect&,
+                     const sf::Color&);
+
+    protected:
+        void
+        draw(sf::RenderTarget&,
+             sf::RenderStates)
+        const override;
+
+    private:
+        void
+        addGlyph(const sf::Uint32,
+                 const float left,
+                 const float baseline,
+                 const sf::Color&);
+
+        void
+        addQuad(const sf::FloatRect& position,
+                const sf::FloatRect& texture,
+                const sf::Color&);
+    };
+}
+
+#endif // TEDIT_TEXT_RENDERER_HPP
\ No newline at end of file
@@ -0,0 +1,75 @@
+#ifndef TEDIT_TRIPLE_BUFFER_HPP
+#define TEDIT_TRIPLE_BUFFER_HPP
+
+#include <atomic>
+#include <cstdint>
+
+namespace tedit
+{
+    // Hands values from one writer thread to one reader thread without
+    // locks. Each side owns a slot, the third is swapped between them, so
+    // neither ever waits for the other and the reader always gets the
+    // latest value published.
+    template <typename T>
+    class TripleBuffer
+    {
+    private:
+        static constexpr std::uint8_t s_fresh = 0x4; // Set on the middle slot when published and not read yet
+        static constexpr std::uint8_t s_index = 0x3;
+
+        T                         m_slots[3];
+        std::atomic<std::uint8_t> m_middle;
+        std::uint8_t              m_back;  // Owned by the writer
+        std::uint8_t              m_front; // Owned by the reader
+
+    public:
+        TripleBuffer()
+            : m_middle(1),
+              m_back(0),
+              m_front(2)
+        {
+        }
+
+        // The slot to write the next value in, it may hold an old value
+        T&
+        back()
+        noexcept
+        {
+            return m_slots[m_back];
+        }
+
+        void
+        publish()
+        noexcept
+        {
+            m_back = m_middle.exchange(m_back | s_fresh, std::memory_order_acq_rel) & s_index;
+        }
+
+        bool
+        hasFresh()
+        const noexcept
+        {
+            return m_middle.load(std::memory_order_acquire) & s_fresh;
+        }
+
+        // Swaps in the latest value, false when nothing new was published
+        bool
+        fetch()
+        noexcept
+        {
+            if (!hasFresh()) return false;
+
+            m_front = m_middle.exchange(m_front, std::memory_order_acq_rel) & s_index;
+            return true;
+        }
+
+        const T&
+        front()
+        const noexcept
+        {
+            return m_slots[m_front];
+        }
+    };
+}
+
+#endif // TEDIT_TRIPLE_BUFFER_HPP
\ No newline at end of file
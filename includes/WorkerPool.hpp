@@ -0,0 +1,193 @@
+#ifndef TEDIT_WORKER_POOL_HPP
+#define TEDIT_WORKER_POOL_HPP
+
+#include <vector>
+#include <deque>
+#include <array>
+#include <memory>
+#include <functional>
+#include <thread>
+#include <mutex>
+#include <condition_variable>
+#include <atomic>
+#include <type_traits>
+#include <algorithm>
+#include <limits>
+
+#define TEDIT_WORKERS_MIN 4 // A worker can be held up for long by a dialog or a whole file
+
+namespace tedit
+{
+    // Threads running the editor's background jobs. Every worker has its
+    // own queues and the idle ones steal from the others. Completions run
+    // on the thread calling dispatch(), which is the editor's
+    class WorkerPool
+    {
+    public:
+        enum class Priority
+        {
+            High,   // Someone is waiting on it
+            Normal,
+            Low,    // Bulk work
+        };
+
+        // Handle of a job, shared by whoever submitted it and the job
+        // itself. Jobs check it to stop early, the completion of a
+        // cancelled job never runs
+        class Token
+        {
+        private:
+            struct State
+            {
+                std::atomic<bool> cancelled;
+                std::atomic<bool> done;
+            };
+
+            std::shared_ptr<State> m_state;
+
+            friend class WorkerPool;
+
+        public:
+            Token();
+
+            void
+            cancel()
+            noexcept;
+
+            bool
+            isCancelled()
+            const noexcept;
+
+            // Ran or was dropped, its completion may still be waiting
+            bool
+            isDone()
+            const noexcept;
+        };
+
+    private:
+        struct Task
+        {
+            std::function<void(const Token&)> run;
+            Token                             token;
+        };
+
+        // The owner takes from the back, thieves from the front
+        struct Queue
+        {
+            std::mutex                      mutex;
+            std::array<std::deque<Task>, 3> tasks; // By priority
+        };
+
+        struct Completion
+        {
+            std::function<void()> run;
+            Token                 token;
+        };
+
+        static thread_local std::size_t s_worker; // Index of the worker running on this thread
+
+        std::vector<std::unique_ptr<Queue>> m_queues;
+        std::vector<std::thread>            m_threads;
+        std::atomic<std::size_t>            m_next; // Queue the next job from outside goes to
+
+        std::mutex              m_mutex;
+        std::condition_variable m_work;     // A job was queued
+        std::condition_variable m_finished; // A job is done
+        std::size_t             m_pending;  // Queued and not claimed by a worker
+        std::size_t             m_running;
+        bool                    m_stopped;
+
+        std::mutex              m_completed_mutex;
+        std::vector<Completion> m_completed;
+
+    public:
+        explicit WorkerPool(const std::size_t threads =
+            std::max<std::size_t>(TEDIT_WORKERS_MIN, std::thread::hardware_concurrency()));
+
+        WorkerPool(const WorkerPool&) = delete;
+
+        WorkerPool&
+        operator=(const WorkerPool&) = delete;
+
+        // Jobs still queued are dropped, the running ones are waited for
+        ~WorkerPool();
+
+        // Runs `work(token)` on a worker, then `done(result)` on the next
+        // dispatch() unless the job was cancelled
+        template <typename Work, typename Done>
+        Token
+        submit(const Priority priority,
+               Work work,
+               Done done)
+        {
+            using Result = std::invoke_result_t<Work&, const Token&>;
+
+            auto shared_done = std::make_shared<Done>(std::move(done));
+
+            return push(priority,
+                [this, work = std::make_shared<Work>(std::move(work)), shared_done](const Token& token)
+                {
+                    if constexpr (std::is_void_v<Result>)
+                    {
+                        (*work)(token);
+                        complete(token, [shared_done] { (*shared_done)(); });
+                    }
+                    else
+                    {
+                        auto result = std::make_shared<Result>((*work)(token));
+                        complete(token, [shared_done, result] { (*shared_done)(std::move(*result)); });
+                    }
+                });
+        }
+
+        // A job with nothing to run on the editor's thread
+        template <typename Work>
+        Token
+        submit(const Priority priority,
+               Work work)
+        {
+            return push(priority,
+                [work = std::make_shared<Work>(std::move(work))](const Token& token)
+                {
+                    (*work)(token);
+                });
+        }
+
+        // Runs the completions of the jobs finished since the last call
+        void
+        dispatch();
+
+        // Blocks until the job has run or was dropped
+        void
+        wait(const Token&);
+
+        // Jobs are queued, running or waiting for dispatch()
+        bool
+        isBusy();
+
+        std::size_t
+        size()
+        const noexcept;
+
+    private:
+        Token
+        push(const Priority,
+             std::function<void(const Token&)>);
+
+        void
+        complete(const Token&,
+                 std::function<void()>);
+
+        void
+        run(const std::size_t index);
+
+        bool
+        take(const std::size_t index,
+             Task&);
+
+        void
+        finish(const Token&);
+    };
+}
+
+#endif // TEDIT_WORKER_POOL_HPP
\ No newline at end of file